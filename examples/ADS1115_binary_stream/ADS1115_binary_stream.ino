@@ -0,0 +1,103 @@
+// I2C device class (I2Cdev) demonstration Arduino sketch for ADS1115 class
+// Example of streaming four devices at 860 SPS as binary packets
+// Updates should (hopefully) always be available at https://github.com/jrowberg/i2cdevlib
+//
+// Changelog:
+//     2026-10-16 - initial release
+
+/* ============================================
+I2Cdev device library code is placed under the MIT license
+Copyright (c) 2011 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+
+
+Wiring four ADS1115 modules to an Arduino UNO
+
+ADS1115 -->  UNO
+  VDD        5V
+  GND        GND
+  SCL        A5 (or SCL)
+  SDA        A4 (or SDA)
+  ADDR       GND, VDD, SDA and SCL, one per module
+
+Decode the output on the host with extras/tools/frame_dump.cpp.
+
+*/
+
+#include "ADS1115.h"
+#include "ADS1115Stream.h"
+#include "ADS1115Frame.h"
+
+const uint8_t DEVICES = 4;
+
+ADS1115 adc[DEVICES] = {
+    ADS1115(ADS1115_ADDRESS_ADDR_GND),
+    ADS1115(ADS1115_ADDRESS_ADDR_VDD),
+    ADS1115(ADS1115_ADDRESS_ADDR_SDA),
+    ADS1115(ADS1115_ADDRESS_ADDR_SCL)
+};
+ADS1115Stream stream[DEVICES] = {
+    ADS1115Stream(adc[0]), ADS1115Stream(adc[1]),
+    ADS1115Stream(adc[2]), ADS1115Stream(adc[3])
+};
+
+// One channel per device (AIN0), 8 frames per packet: 82 bytes per 8 frames
+ADS1115FrameSender sender(Serial);
+
+int16_t frame[DEVICES];
+uint32_t frameTime;
+uint8_t fresh = 0;
+
+void setup() {
+    Wire.begin();
+    Wire.setClock(400000);
+    Serial.begin(115200);
+
+    for (uint8_t i = 0; i < DEVICES; i++) {
+        adc[i].initialize();
+        adc[i].beginConfig();
+        adc[i].setMultiplexer(ADS1115_MUX_P0_NG);
+        adc[i].setGain(ADS1115_PGA_4P096);
+        adc[i].setRate(ADS1115_RATE_860);
+        adc[i].commit();
+        stream[i].begin();
+    }
+    sender.begin(0x000F, 8);
+}
+
+void loop() {
+    ADS1115StreamSample sample;
+
+    // Emit a frame once every device has delivered a new sample
+    for (uint8_t i = 0; i < DEVICES; i++) {
+        if (stream[i].poll(sample)) {
+            if (i == 0) {
+                frameTime = sample.timestamp;
+            }
+            frame[i] = sample.value;
+            fresh |= 1 << i;
+        }
+    }
+    if (fresh == (1 << DEVICES) - 1) {
+        sender.append(frame, frameTime);
+        fresh = 0;
+    }
+}
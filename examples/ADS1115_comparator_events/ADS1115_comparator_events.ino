@@ -0,0 +1,96 @@
+// I2C device class (I2Cdev) demonstration Arduino sketch for ADS1115 class
+// Example of threshold monitoring through the comparator and ALERT/RDY pin:
+// the sketch only talks to the ADS1115 when the input has moved
+// Updates should (hopefully) always be available at https://github.com/jrowberg/i2cdevlib
+//
+// Changelog:
+//     2026-10-16 - initial release
+
+/* ============================================
+I2Cdev device library code is placed under the MIT license
+Copyright (c) 2011 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+
+
+Wiring the ADS1115 Module to an Arduino UNO
+
+ADS1115 -->  UNO
+  VDD        5V
+  GND        GND
+  SCL        A5 (or SCL)
+  SDA        A4 (or SDA)
+  ALRT       2
+
+
+*/
+
+#include "ADS1115.h"
+
+ADS1115 adc0(ADS1115_DEFAULT_ADDRESS);
+
+// Wire ADS1115 ALERT/RDY pin to Arduino pin 2
+const int alertReadyPin = 2;
+
+// Filled by the ALERT interrupt, drained by loop()
+ADS1115StaticRing<int16_t, 16> changes;
+
+void comparatorAlert() {
+    // Wire needs its own TWI interrupt to finish the read, but this one
+    // must not nest: mask INT0 (pin 2 on the UNO) first. An edge during
+    // the read stays latched and runs the handler again afterwards.
+    EIMSK &= ~_BV(INT0);
+    interrupts();
+    adc0.onComparatorAlert();
+    noInterrupts();
+    EIMSK |= _BV(INT0);
+}
+
+void setup() {
+    Wire.begin();
+    Wire.setClock(400000);
+    Serial.begin(115200);
+
+    adc0.initialize();
+    adc0.setGain(ADS1115_PGA_4P096);
+    adc0.setRate(ADS1115_RATE_128);
+
+    // Report AIN0 whenever it has moved more than 50 mV, starting with the
+    // first reading outside 2.45 .. 2.55 V
+    pinMode(alertReadyPin, INPUT_PULLUP);
+    if (!adc0.beginComparatorEvents(changes, ADS1115_MUX_P0_NG, 2450000,
+                                    2550000)) {
+        Serial.println("ADS1115 not responding");
+        return;
+    }
+    adc0.setEventDeadband(50000);
+    attachInterrupt(digitalPinToInterrupt(alertReadyPin), comparatorAlert, FALLING);
+}
+
+void loop() {
+    int16_t raw;
+
+    while (changes.pop(raw)) {
+        Serial.print("AIN0 now ");
+        Serial.print(ADS1115CFG::microVolts(raw, ADS1115_PGA_4P096) / 1000);
+        Serial.println(" mV");
+    }
+    // Nothing else to do: the ADS1115 watches the input on its own
+}
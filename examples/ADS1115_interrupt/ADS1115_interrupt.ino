@@ -0,0 +1,100 @@
+// I2C device class (I2Cdev) demonstration Arduino sketch for ADS1115 class
+// Example of interrupt-driven continuous sampling through the ALERT/RDY pin
+// Updates should (hopefully) always be available at https://github.com/jrowberg/i2cdevlib
+//
+// Changelog:
+//     2026-10-16 - initial release
+
+/* ============================================
+I2Cdev device library code is placed under the MIT license
+Copyright (c) 2011 Jeff Rowberg
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+===============================================
+
+
+Wiring the ADS1115 Module to an Arduino UNO
+
+ADS1115 -->  UNO
+  VDD        5V
+  GND        GND
+  SCL        A5 (or SCL)
+  SDA        A4 (or SDA)
+  ALRT       2
+
+
+*/
+
+#include "ADS1115.h"
+
+ADS1115 adc0(ADS1115_DEFAULT_ADDRESS);
+
+// Wire ADS1115 ALERT/RDY pin to Arduino pin 2
+const int alertReadyPin = 2;
+
+// Filled by the RDY interrupt, drained by loop()
+ADS1115StaticRing<int16_t, 64> samples;
+
+void conversionReady() {
+    // Wire needs its own TWI interrupt to finish the read, but this one
+    // must not nest: mask INT0 (pin 2 on the UNO) first. An edge during
+    // the read stays latched and runs the handler again afterwards.
+    EIMSK &= ~_BV(INT0);
+    interrupts();
+    adc0.onConversionReady();
+    noInterrupts();
+    EIMSK |= _BV(INT0);
+}
+
+void setup() {
+    Wire.begin();
+    Wire.setClock(400000);
+    Serial.begin(115200);
+
+    adc0.initialize();
+    adc0.beginConfig();
+    adc0.setMultiplexer(ADS1115_MUX_P0_NG);
+    adc0.setGain(ADS1115_PGA_4P096);
+    adc0.setRate(ADS1115_RATE_860);
+    adc0.commit();
+
+    pinMode(alertReadyPin, INPUT_PULLUP);
+    if (!adc0.beginReadyAcquisition(samples)) {
+        Serial.println("ADS1115 not responding");
+        return;
+    }
+    attachInterrupt(digitalPinToInterrupt(alertReadyPin), conversionReady, FALLING);
+}
+
+void loop() {
+    int16_t batch[32];
+    uint16_t count = samples.popBatch(batch, 32);
+    int32_t sum = 0;
+
+    if (count == 0) {
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        sum += batch[i];
+    }
+    Serial.print(count); Serial.print(" samples, mean ");
+    Serial.print(sum / count); Serial.print(" counts, overruns ");
+    Serial.println(samples.getOverruns() + adc0.getMissedReadyEdges());
+    delay(20);
+}
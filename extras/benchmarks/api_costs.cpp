@@ -0,0 +1,406 @@
+// Per-call cost of the public ADS1115 API on the simulated bus: I2C
+// transactions, bytes on the wire (address bytes included), bus time and
+// end-to-end latency in virtual time at 100 kHz, 400 kHz and 3.4 MHz, and
+// host CPU time per call. Every case starts from a freshly initialized
+// device (single-shot, 860 SPS unless the case says otherwise), makes one
+// warm-up call and averages the next ones. Setters alternate between two
+// values so each call changes something.
+//
+// Transaction, byte and virtual-time figures are deterministic; CPU time
+// includes the simulator's own bookkeeping and is only comparable between
+// runs on the same machine.
+//
+// Results go to stdout and, as CSV, to a file. With a baseline file the run
+// fails if any case now needs more transactions or bytes, or more than 1%
+// more latency, than recorded there.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -DADS1115_BUS_SIM -I../../src -o api_costs
+//       api_costs.cpp ../../src/*.cpp
+//   ./api_costs [results.csv [baseline.csv]]
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ADS1115.h"
+
+#define CALLS       16          // averaged per case and clock
+#define CPU_MIN_NS  20000000    // CPU timing runs at least this long
+
+struct Fixture {
+    ADS1115SimBus bus;
+    ADS1115SimDevice sim;
+    ADS1115 adc;
+    ADS1115StaticRing<int16_t, 16> ring;
+    ADS1115Boxcar<4> boxcar;
+    ADS1115AutoRange range;
+
+    Fixture(uint32_t hz) :
+        sim(ADS1115_ADDRESS_ADDR_GND),
+        adc(bus, ADS1115_ADDRESS_ADDR_GND),
+        range(ADS1115_MUX_P0_NG)
+    {
+        bus.setClock(hz);
+        bus.attach(sim);
+        for (uint8_t pin = 0; pin < 4; pin++) {
+            sim.setVoltage(pin, 250000 * (pin + 1));
+        }
+        adc.initialize();
+        adc.setRate(ADS1115_RATE_860);
+    }
+};
+
+typedef void (*Setup)(Fixture &f);
+typedef void (*Call)(Fixture &f, uint32_t i);
+
+struct Case {
+    const char *name;
+    Setup setup;
+    Call call;
+};
+
+static void singleShot(Fixture &) {}
+
+static void continuous(Fixture &f)
+{
+    f.adc.setMode(ADS1115_MODE_CONTINUOUS);
+    f.bus.sleepMicros(2000);
+}
+
+static void readyPin(Fixture &f)
+{
+    f.adc.beginReadyAcquisition(f.ring);
+    f.bus.sleepMicros(2000);
+}
+
+static void alertEvents(Fixture &f)
+{
+    f.adc.beginComparatorEvents(f.ring, ADS1115_MUX_P0_NG, 0, 100000);
+    f.adc.setEventDeadband(10000);
+    f.bus.sleepMicros(2000);
+}
+
+static const ADS1115ScanChannel scanList[4] = {
+    { ADS1115_MUX_P0_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P1_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P2_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P3_NG, ADS1115_PGA_4P096 }
+};
+
+static volatile int32_t sink;
+
+static const Case cases[] = {
+    { "initialize", singleShot,
+      [](Fixture &f, uint32_t) { f.adc.initialize(); } },
+    { "testConnection", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.testConnection(); } },
+    { "getConfig", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConfig(); } },
+    { "setConfig", singleShot,
+      [](Fixture &f, uint32_t i) { f.adc.setConfig(i & 1 ? 0x05E3 : 0x0583); } },
+    { "isConversionReady", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.isConversionReady(); } },
+    { "triggerConversion+waitForConversion", singleShot,
+      [](Fixture &f, uint32_t) {
+          f.adc.triggerConversion();
+          sink = f.adc.waitForConversion();
+      } },
+    { "triggerConversion+pollConversion(1000)", singleShot,
+      [](Fixture &f, uint32_t) {
+          f.adc.triggerConversion();
+          sink = f.adc.pollConversion(1000);
+      } },
+    { "getConversion(true)", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversion(true); } },
+    { "getConversion(false)", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversion(false); } },
+    { "getConversionP0N1", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP0N1(); } },
+    { "getConversionP0N3", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP0N3(); } },
+    { "getConversionP1N3", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP1N3(); } },
+    { "getConversionP2N3", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP2N3(); } },
+    { "getConversionP0GND", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP0GND(); } },
+    { "getConversionP1GND", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP1GND(); } },
+    { "getConversionP2GND", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP2GND(); } },
+    { "getConversionP3GND", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversionP3GND(); } },
+#ifndef ADS1115_NO_FLOAT
+    { "getMilliVolts(true)", singleShot,
+      [](Fixture &f, uint32_t) { sink = (int32_t)f.adc.getMilliVolts(true); } },
+    { "getMilliVolts(false)", singleShot,
+      [](Fixture &f, uint32_t) { sink = (int32_t)f.adc.getMilliVolts(false); } },
+    { "getMvPerCount", singleShot,
+      [](Fixture &f, uint32_t) { sink = (int32_t)f.adc.getMvPerCount(); } },
+#endif
+    { "getMicroVolts(true)", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getMicroVolts(true); } },
+    { "getMicroVolts(false)", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getMicroVolts(false); } },
+    { "getFullScale", singleShot,
+      [](Fixture &f, uint32_t i) { sink = f.adc.getFullScale(i & 7); } },
+    { "getMultiplexer", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getMultiplexer(); } },
+    { "setMultiplexer", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setMultiplexer(i & 1 ? ADS1115_MUX_P1_NG : ADS1115_MUX_P0_NG);
+      } },
+    { "getGain", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getGain(); } },
+    { "setGain", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setGain(i & 1 ? ADS1115_PGA_4P096 : ADS1115_PGA_2P048);
+      } },
+    { "getMode", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getMode(); } },
+    { "setMode", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setMode(i & 1 ? ADS1115_MODE_CONTINUOUS :
+                                ADS1115_MODE_SINGLESHOT);
+      } },
+    { "getRate", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getRate(); } },
+    { "setRate", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setRate(i & 1 ? ADS1115_RATE_475 : ADS1115_RATE_860);
+      } },
+    { "getComparatorMode", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getComparatorMode(); } },
+    { "setComparatorMode", singleShot,
+      [](Fixture &f, uint32_t i) { f.adc.setComparatorMode(i & 1); } },
+    { "getComparatorPolarity", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getComparatorPolarity(); } },
+    { "setComparatorPolarity", singleShot,
+      [](Fixture &f, uint32_t i) { f.adc.setComparatorPolarity(i & 1); } },
+    { "getComparatorLatchEnabled", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getComparatorLatchEnabled(); } },
+    { "setComparatorLatchEnabled", singleShot,
+      [](Fixture &f, uint32_t i) { f.adc.setComparatorLatchEnabled(i & 1); } },
+    { "getComparatorQueueMode", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getComparatorQueueMode(); } },
+    { "setComparatorQueueMode", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setComparatorQueueMode(i & 1 ? ADS1115_COMP_QUE_ASSERT1 :
+                                               ADS1115_COMP_QUE_DISABLE);
+      } },
+    { "setConversionReadyPinMode", singleShot,
+      [](Fixture &f, uint32_t) { f.adc.setConversionReadyPinMode(); } },
+    { "getLowThreshold", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getLowThreshold(); } },
+    { "setLowThreshold", singleShot,
+      [](Fixture &f, uint32_t i) { f.adc.setLowThreshold(i & 1 ? -100 : 100); } },
+    { "getHighThreshold", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.getHighThreshold(); } },
+    { "setHighThreshold", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setHighThreshold(i & 1 ? 20000 : 10000);
+      } },
+    { "setThresholdsMilliVolts", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setThresholdsMilliVolts(i & 1 ? -100 : 100, i & 1 ? 900 : 1000);
+      } },
+    { "beginConfig+3 setters+commit", singleShot,
+      [](Fixture &f, uint32_t i) {
+          f.adc.beginConfig();
+          f.adc.setMultiplexer(i & 1 ? ADS1115_MUX_P1_NG : ADS1115_MUX_P0_NG);
+          f.adc.setGain(i & 1 ? ADS1115_PGA_4P096 : ADS1115_PGA_2P048);
+          f.adc.setRate(i & 1 ? ADS1115_RATE_475 : ADS1115_RATE_860);
+          f.adc.commit();
+      } },
+    { "sync", singleShot,
+      [](Fixture &f, uint32_t) { f.adc.sync(); } },
+    { "verify", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.verify(); } },
+    { "readConversion(5000)", singleShot,
+      [](Fixture &f, uint32_t) { sink = f.adc.readConversion(5000).value; } },
+    { "readChannel(5000)", singleShot,
+      [](Fixture &f, uint32_t i) {
+          sink = f.adc.readChannel(scanList[i & 3], 5000).value;
+      } },
+    { "scan(4 channels)", singleShot,
+      [](Fixture &f, uint32_t) {
+          int16_t out[4];
+          sink = f.adc.scan(scanList, 4, out);
+      } },
+    { "startConversion+poll", singleShot,
+      [](Fixture &f, uint32_t) {
+          ADS1115Conversion c = f.adc.startConversion(ADS1115_MUX_P0_NG,
+                                                      ADS1115_PGA_4P096,
+                                                      ADS1115_RATE_860);
+          while (f.adc.poll(c) == ADS1115_STATUS_PENDING) {
+              uint32_t elapsed = f.bus.micros() - c.started;
+              f.bus.sleepMicros(c.pollAt > elapsed ? c.pollAt - elapsed : 1);
+          }
+          sink = c.value;
+      } },
+    { "getFilteredConversion(boxcar 4)", singleShot,
+      [](Fixture &f, uint32_t) {
+          sink = f.adc.getFilteredConversion(f.boxcar);
+      } },
+    { "getAutoRanged", singleShot,
+      [](Fixture &f, uint32_t) {
+          sink = f.adc.getAutoRanged(f.range).microVolts;
+      } },
+    { "continuous/getConversion(false)", continuous,
+      [](Fixture &f, uint32_t) { sink = f.adc.getConversion(false); } },
+    { "continuous/getMicroVolts(false)", continuous,
+      [](Fixture &f, uint32_t) { sink = f.adc.getMicroVolts(false); } },
+    { "continuous/setMultiplexer", continuous,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setMultiplexer(i & 1 ? ADS1115_MUX_P1_NG : ADS1115_MUX_P0_NG);
+      } },
+    { "continuous/setGain", continuous,
+      [](Fixture &f, uint32_t i) {
+          f.adc.setGain(i & 1 ? ADS1115_PGA_4P096 : ADS1115_PGA_2P048);
+      } },
+    { "ready/onConversionReady", readyPin,
+      [](Fixture &f, uint32_t) {
+          int16_t value;
+          sink = f.adc.onConversionReady();
+          f.ring.pop(value);
+      } },
+    { "events/onComparatorAlert", alertEvents,
+      [](Fixture &f, uint32_t) {
+          int16_t value;
+          sink = f.adc.onComparatorAlert();
+          f.ring.pop(value);
+      } },
+};
+
+static const uint32_t clocks[] = { 100000, 400000, 3400000 };
+
+struct Result {
+    std::string name;
+    uint32_t hz;
+    double transactions, bytes, busUs, latencyUs, cpuNs;
+};
+
+static double cpuCost(const Case &c)
+{
+    Fixture f(400000);
+    uint32_t calls = 0;
+    std::chrono::steady_clock::time_point start;
+    double elapsed;
+
+    c.setup(f);
+    c.call(f, 0);
+    start = std::chrono::steady_clock::now();
+    do {
+        for (uint32_t i = 0; i < 64; i++) {
+            c.call(f, ++calls);
+        }
+        elapsed = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < CPU_MIN_NS);
+    return elapsed / calls;
+}
+
+static Result measure(const Case &c, uint32_t hz, double cpuNs)
+{
+    Fixture f(hz);
+    Result r;
+    uint64_t start;
+
+    c.setup(f);
+    c.call(f, 0);
+    f.bus.resetCounters();
+    start = f.bus.nanos();
+    for (uint32_t i = 1; i <= CALLS; i++) {
+        c.call(f, i);
+    }
+    r.name = c.name;
+    r.hz = hz;
+    r.transactions = (double)f.bus.getTransactions() / CALLS;
+    r.bytes = (double)f.bus.getBytes() / CALLS;
+    r.busUs = f.bus.getBusyNanos() / 1e3 / CALLS;
+    r.latencyUs = (f.bus.nanos() - start) / 1e3 / CALLS;
+    r.cpuNs = cpuNs;
+    return r;
+}
+
+// Baseline rows that got worse; returns the number of regressions
+static int compare(const std::vector<Result> &results, const char *path)
+{
+    FILE *in = fopen(path, "r");
+    char line[256];
+    int regressions = 0, matched = 0;
+
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), in)) {
+        char name[128];
+        unsigned hz;
+        double tx, bytes, bus, latency;
+        if (sscanf(line, "%127[^,],%u,%lf,%lf,%lf,%lf", name, &hz, &tx,
+                   &bytes, &bus, &latency) != 6) {
+            continue;   // header
+        }
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result &r = results[i];
+            if (r.name != name || r.hz != hz) {
+                continue;
+            }
+            matched++;
+            if (r.transactions > tx + 1e-9 || r.bytes > bytes + 1e-9 ||
+                r.latencyUs > latency * 1.01 + 1e-3) {
+                printf("REGRESSION %s @ %u Hz: tx %.2f -> %.2f, bytes "
+                       "%.2f -> %.2f, latency %.1f -> %.1f us\n", name, hz,
+                       tx, r.transactions, bytes, r.bytes, latency,
+                       r.latencyUs);
+                regressions++;
+            }
+        }
+    }
+    fclose(in);
+    printf("%d baseline rows compared, %d regressions\n", matched,
+           regressions);
+    return regressions;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "api_costs.csv";
+    std::vector<Result> results;
+    FILE *out;
+
+    printf("%-40s %9s %6s %7s %10s %11s %9s\n", "case", "clock", "tx",
+           "bytes", "bus us", "latency us", "cpu ns");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        double cpuNs = cpuCost(cases[c]);
+        for (size_t k = 0; k < sizeof(clocks) / sizeof(clocks[0]); k++) {
+            Result r = measure(cases[c], clocks[k], cpuNs);
+            printf("%-40s %9u %6.2f %7.2f %10.1f %11.1f %9.0f\n",
+                   r.name.c_str(), r.hz, r.transactions, r.bytes, r.busUs,
+                   r.latencyUs, r.cpuNs);
+            results.push_back(r);
+        }
+    }
+
+    out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return 1;
+    }
+    fprintf(out, "case,clock_hz,transactions,bytes,bus_us,latency_us,"
+                 "cpu_ns\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        fprintf(out, "%s,%u,%.4f,%.4f,%.3f,%.3f,%.1f\n", r.name.c_str(),
+                r.hz, r.transactions, r.bytes, r.busUs, r.latencyUs,
+                r.cpuNs);
+    }
+    fclose(out);
+    printf("wrote %s\n", path);
+
+    return argc > 2 && compare(results, argv[2]) ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+// I2C_RDWR batching check: scans four devices on one Linux bus whose ioctl
+// is replaced by a fake i2c-dev that forwards every message to simulated
+// devices. Runs the same scan with one driver call per operation and with
+// ADS1115BatchScan (for 1 to 4 devices), compares the results with the
+// simulated inputs and prints the ioctl count of each. The batched count
+// depends only on the channel count: one call to trigger, then a status
+// call and a read+trigger call per channel.
+//
+// Build and run from this directory (Linux):
+//   g++ -O2 -std=c++11 -I../../src -o batch_syscalls
+//       batch_syscalls.cpp ../../src/*.cpp
+//   ./batch_syscalls [scans]
+
+#include <errno.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "ADS1115.h"
+#include "ADS1115SimBus.h"
+
+#define DEVICES     4
+#define CHANNELS    4
+
+static ADS1115SimDevice *sims[DEVICES];
+static std::chrono::steady_clock::time_point epoch =
+    std::chrono::steady_clock::now();
+
+// Fake i2c-dev: the kernel's I2C_RDWR contract on top of ADS1115SimDevice
+static int fakeIoctl(int, unsigned long request, void *arg)
+{
+    struct i2c_rdwr_ioctl_data *xfer = (struct i2c_rdwr_ioctl_data *)arg;
+
+    if (request != I2C_RDWR || xfer->nmsgs > I2C_RDWR_IOCTL_MAX_MSGS) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (uint32_t i = 0; i < xfer->nmsgs; i++) {
+        struct i2c_msg &msg = xfer->msgs[i];
+        ADS1115SimDevice *sim = 0;
+        for (uint8_t d = 0; d < DEVICES; d++) {
+            if (sims[d]->getAddress() == msg.addr) {
+                sim = sims[d];
+            }
+        }
+        if (!sim) {
+            errno = ENXIO;
+            return -1;
+        }
+        // the devices convert in real time, like the bus sleeps
+        sim->update(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+        if (msg.flags & I2C_M_RD) {
+            sim->read(msg.buf, (uint8_t)msg.len);
+        } else {
+            sim->write(msg.buf, (uint8_t)msg.len);
+        }
+    }
+    return (int)xfer->nmsgs;
+}
+
+static const ADS1115ScanChannel channels[CHANNELS] = {
+    { ADS1115_MUX_P0_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P1_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P2_NG, ADS1115_PGA_2P048 },
+    { ADS1115_MUX_P3_NG, ADS1115_PGA_1P024 }
+};
+
+static int16_t expected(uint8_t device, uint8_t channel)
+{
+    return (int16_t)(1000 * (device + 1) + channel);
+}
+
+static bool check(int16_t out[DEVICES][CHANNELS])
+{
+    for (uint8_t d = 0; d < DEVICES; d++) {
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            if (out[d][c] != expected(d, c)) {
+                printf("mismatch device %u channel %u: %d\n", d, c,
+                       out[d][c]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int scans = argc > 1 ? atoi(argv[1]) : 100;
+    const uint8_t addresses[DEVICES] = {
+        ADS1115_ADDRESS_ADDR_GND, ADS1115_ADDRESS_ADDR_VDD,
+        ADS1115_ADDRESS_ADDR_SDA, ADS1115_ADDRESS_ADDR_SCL
+    };
+    ADS1115LinuxBus bus("/dev/null");
+    ADS1115 *adcs[DEVICES];
+    int16_t out[DEVICES][CHANNELS];
+    bool ok = true;
+
+    bus.setIoctl(fakeIoctl);
+    for (uint8_t d = 0; d < DEVICES; d++) {
+        sims[d] = new ADS1115SimDevice(addresses[d]);
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            sims[d]->setInput(channels[c].mux, expected(d, c));
+        }
+    }
+    for (uint8_t d = 0; d < DEVICES; d++) {
+        adcs[d] = new ADS1115(bus, addresses[d]);
+        adcs[d]->initialize();
+        adcs[d]->setRate(ADS1115_RATE_860);
+    }
+    if (!bus.isOpen()) {
+        printf("cannot open /dev/null\n");
+        return 1;
+    }
+
+    // One driver call per operation
+    bus.resetIoctlCount();
+    for (int s = 0; s < scans; s++) {
+        for (uint8_t d = 0; d < DEVICES; d++) {
+            ok = ok && adcs[d]->scan(channels, CHANNELS, out[d]) == CHANNELS;
+        }
+    }
+    ok = ok && check(out);
+    uint32_t single = bus.getIoctlCount();
+
+    printf("%u devices x %u channels, %d scans\n", DEVICES, CHANNELS, scans);
+    printf("ioctls per scan: single %.1f\n", (double)single / scans);
+
+    // Status-gated batches, the same number of calls for any device count
+    for (uint8_t n = 1; n <= DEVICES; n++) {
+        ADS1115BatchScan batched(bus);
+        for (uint8_t d = 0; d < n; d++) {
+            batched.add(*adcs[d], channels, CHANNELS);
+        }
+        memset(out, 0, sizeof(out));
+        bus.resetIoctlCount();
+        for (int s = 0; s < scans; s++) {
+            ok = ok && batched.scan(&out[0][0]) == n * CHANNELS;
+        }
+        ok = ok && (n < DEVICES || check(out));
+        printf("ioctls per scan: batched %.1f with %u device%s\n",
+               (double)bus.getIoctlCount() / scans, n, n > 1 ? "s" : "");
+    }
+    printf("%s\n", ok ? "results match" : "FAILED");
+
+    for (uint8_t d = 0; d < DEVICES; d++) {
+        delete adcs[d];
+        delete sims[d];
+    }
+    return ok ? 0 : 1;
+}
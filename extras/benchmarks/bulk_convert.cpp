@@ -0,0 +1,85 @@
+// Host benchmark: ADS1115Bulk kernels against the per-sample getMvPerCount()
+// style conversion on multi-million-sample, four-channel buffers.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -I../../src -o bulk_convert
+//       bulk_convert.cpp ../../src/ADS1115Bulk.cpp
+//   ./bulk_convert [samples]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ADS1115CFG.h"
+#include "ADS1115Bulk.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? strtoul(argv[1], 0, 10) : 16u * 1024 * 1024;
+    const uint8_t channels = 4;
+    const uint8_t pga[channels] = { 0, 2, 3, 5 };
+    const int rounds = 5;
+
+    std::vector<int16_t> raw(count);
+    std::vector<float> mv(count);
+    std::vector<int32_t> uv(count), reference(count);
+
+    srand(1);
+    for (size_t i = 0; i < count; i++) {
+        raw[i] = (int16_t)(rand() & 0xFFFF);
+    }
+    for (size_t i = 0; i < count; i++) {
+        reference[i] = ADS1115CFG::microVolts(raw[i], pga[i % channels]);
+    }
+
+    // Baseline: what a sketch does today, one table lookup + float multiply
+    // per sample.
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            mv[i] = (float)raw[i] * ADS1115CFG::mvPerCount(pga[i % channels]);
+        }
+    }
+    double base = seconds(start) / rounds;
+    printf("%-22s %8.2f Msps\n", "per-sample float", count / base / 1e6);
+
+    const ADS1115Bulk::Kernel kernels[] = {
+        ADS1115Bulk::KERNEL_SCALAR, ADS1115Bulk::KERNEL_SSE41,
+        ADS1115Bulk::KERNEL_AVX2, ADS1115Bulk::KERNEL_NEON
+    };
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!ADS1115Bulk::setKernel(kernels[k])) {
+            continue;
+        }
+        const char *name = ADS1115Bulk::getKernelName(kernels[k]);
+
+        start = Clock::now();
+        for (int r = 0; r < rounds; r++) {
+            ADS1115Bulk::toMilliVolts(&raw[0], &mv[0], count, channels, pga);
+        }
+        double tmv = seconds(start) / rounds;
+
+        start = Clock::now();
+        for (int r = 0; r < rounds; r++) {
+            ADS1115Bulk::toMicroVolts(&raw[0], &uv[0], count, channels, pga);
+        }
+        double tuv = seconds(start) / rounds;
+
+        bool exact = uv == reference;
+        printf("%-8s mV %8.2f Msps (%4.1fx)   uV %8.2f Msps (%4.1fx) %s\n",
+               name, count / tmv / 1e6, base / tmv, count / tuv / 1e6,
+               base / tuv, exact ? "exact" : "MISMATCH");
+        if (!exact) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Simulated-bus benchmark: bus traffic and host wake-ups needed to supervise
+// many slowly drifting inputs, polling every device at a fixed rate against
+// letting each device's comparator raise ALERT when its input has moved by
+// more than a deadband (beginComparatorEvents() + setEventDeadband()).
+//
+// Every bus carries four devices, each converting one input continuously at
+// 128 SPS; each input drifts +/-200 mV around 1 V with its own period of
+// 20..80 s. The polled setups read every device at 10 Hz, or at 128 Hz to
+// see each conversion; the event setup only reads on ALERT, re-arming a
+// +/-20 mV window around each reading, and hears of a change within one
+// conversion like the 128 Hz poll does.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -DADS1115_BUS_SIM -I../../src -o comparator_events
+//       comparator_events.cpp ../../src/*.cpp -lm
+//   ./comparator_events [buses [seconds]]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ADS1115.h"
+
+#define DEADBAND_UV     20000
+#define DRAIN_HZ        10      // main loop rate in the event setup
+
+struct Input {
+    double periodS;
+    double phase;
+};
+
+static int32_t drift(void *context, uint64_t timeNs)
+{
+    const Input *input = (const Input *)context;
+
+    return 1000000 + (int32_t)(200000 * sin(2 * M_PI * (timeNs / 1e9) /
+                                             input->periodS + input->phase));
+}
+
+struct Device {
+    ADS1115SimDevice sim;
+    ADS1115 adc;
+    Input input;
+    ADS1115StaticRing<int16_t, 16> ring;
+    uint32_t wakeups;
+
+    Device(ADS1115SimBus &bus, uint8_t address, uint32_t seed) :
+        sim(address), adc(bus, address), wakeups(0)
+    {
+        input.periodS = 20 + seed * 37 % 61;
+        input.phase = seed * 0.7;
+        bus.attach(sim);
+        sim.setWaveform(0, drift, &input);
+        adc.initialize();
+        adc.setGain(ADS1115_PGA_2P048);
+        adc.setRate(ADS1115_RATE_128);
+    }
+};
+
+static void onAlert(void *context, bool level)
+{
+    Device *device = (Device *)context;
+
+    if (!level) {
+        device->wakeups++;
+        device->adc.onComparatorAlert();
+    }
+}
+
+struct Totals {
+    uint64_t transactions;
+    uint64_t bytes;
+    uint64_t busyNs;
+    uint64_t wakeups;
+    uint64_t samples;
+};
+
+static const uint8_t addresses[4] = {
+    ADS1115_ADDRESS_ADDR_GND, ADS1115_ADDRESS_ADDR_VDD,
+    ADS1115_ADDRESS_ADDR_SDA, ADS1115_ADDRESS_ADDR_SCL
+};
+
+// pollHz 0 = ALERT events
+static void runBus(uint32_t seed, uint32_t seconds, uint32_t pollHz,
+                   Totals &totals)
+{
+    ADS1115SimBus bus;
+    Device *devices[4];
+    bool events = pollHz == 0;
+    uint64_t period = 1000000000 / (events ? DRAIN_HZ : pollHz);
+    int16_t value;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        devices[i] = new Device(bus, addresses[i], seed * 4 + i);
+        if (events) {
+            devices[i]->sim.setAlertHandler(onAlert, devices[i]);
+            devices[i]->adc.beginComparatorEvents(devices[i]->ring,
+                                                  ADS1115_MUX_P0_NG,
+                                                  1000000 - DEADBAND_UV,
+                                                  1000000 + DEADBAND_UV);
+            devices[i]->adc.setEventDeadband(DEADBAND_UV);
+        } else {
+            devices[i]->adc.setMultiplexer(ADS1115_MUX_P0_NG);
+            devices[i]->adc.setMode(ADS1115_MODE_CONTINUOUS);
+        }
+    }
+    bus.resetCounters();
+
+    uint64_t end = bus.nanos() + (uint64_t)seconds * 1000000000;
+    uint64_t tick = bus.nanos();
+    while (bus.nanos() < end) {
+        if (!events) {
+            for (uint8_t i = 0; i < 4; i++) {
+                devices[i]->wakeups++;
+                devices[i]->ring.push(devices[i]->adc.getConversion(false));
+            }
+        }
+        tick += period;
+        if (tick > bus.nanos()) {
+            bus.advance(tick - bus.nanos());
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            while (devices[i]->ring.pop(value)) {
+                totals.samples++;
+            }
+        }
+    }
+
+    totals.transactions += bus.getTransactions();
+    totals.bytes += bus.getBytes();
+    totals.busyNs += bus.getBusyNanos();
+    for (uint8_t i = 0; i < 4; i++) {
+        totals.wakeups += devices[i]->wakeups;
+        delete devices[i];
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t buses = argc > 1 ? atoi(argv[1]) : 32;
+    uint32_t seconds = argc > 2 ? atoi(argv[2]) : 60;
+    uint32_t channels = buses * 4;
+
+    printf("%u channels on %u buses (400 kHz), %u s\n\n", channels, buses,
+           seconds);
+    printf("mode            tx/s/ch  bytes/s/ch  bus busy %%  "
+           "wake-ups/s/ch  readings\n");
+    for (uint8_t m = 0; m < 3; m++) {
+        static const uint32_t pollHz[3] = { 10, 128, 0 };
+        Totals totals = { 0, 0, 0, 0, 0 };
+        char name[24];
+
+        for (uint32_t b = 0; b < buses; b++) {
+            runBus(b, seconds, pollHz[m], totals);
+        }
+        if (pollHz[m]) {
+            snprintf(name, sizeof(name), "poll %u Hz", pollHz[m]);
+        } else {
+            snprintf(name, sizeof(name), "ALERT events");
+        }
+        printf("%-14s %8.2f  %10.1f  %10.3f  %13.2f  %8llu\n", name,
+               (double)totals.transactions / seconds / channels,
+               (double)totals.bytes / seconds / channels,
+               100.0 * totals.busyNs / buses / (seconds * 1e9),
+               (double)totals.wakeups / seconds / channels,
+               (unsigned long long)totals.samples);
+    }
+    return 0;
+}
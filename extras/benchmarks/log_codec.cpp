@@ -0,0 +1,121 @@
+// Log format benchmark: writes a synthetic 4-channel, 860 SPS recording
+// (a slow sine plus a few counts of noise per channel) with
+// ADS1115LogWriter, compares its size with the same data as CSV, then maps
+// it with ADS1115LogReader, checks every sample, and times serial and
+// parallel decoding and time-range lookups.
+//
+// Build and run from this directory (Linux):
+//   g++ -O2 -std=c++11 -pthread -I../../src -o log_codec
+//       log_codec.cpp ../../src/*.cpp
+//   ./log_codec [frames] [file]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ADS1115.h"
+#include "ADS1115Log.h"
+#include "ADS1115LogReader.h"
+
+#define CHANNELS    4
+
+static double seconds(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+int main(int argc, char **argv)
+{
+    long frames = argc > 1 ? atol(argv[1]) : 2000000;
+    const char *path = argc > 2 ? argv[2] : "log_codec.adl";
+    const ADS1115LogChannel channels[CHANNELS] = {
+        { ADS1115_ADDRESS_ADDR_GND, ADS1115_MUX_P0_NG, ADS1115_PGA_4P096,
+          ADS1115_RATE_860, 0 },
+        { ADS1115_ADDRESS_ADDR_GND, ADS1115_MUX_P1_NG, ADS1115_PGA_4P096,
+          ADS1115_RATE_860, 0 },
+        { ADS1115_ADDRESS_ADDR_VDD, ADS1115_MUX_P0_N1, ADS1115_PGA_0P512,
+          ADS1115_RATE_860, 1 },
+        { ADS1115_ADDRESS_ADDR_VDD, ADS1115_MUX_P2_N3, ADS1115_PGA_0P512,
+          ADS1115_RATE_860, 2 }
+    };
+    std::vector<int16_t> samples((size_t)frames * CHANNELS);
+    uint64_t csvBytes = 0;
+    char line[64];
+
+    srand(1);
+    for (long f = 0; f < frames; f++) {
+        uint32_t t = (uint32_t)(f * 1163);
+        for (int c = 0; c < CHANNELS; c++) {
+            int16_t v = (int16_t)(8000 * sin(f * 0.001 * (c + 1)) +
+                                  (rand() % 9) - 4);
+            samples[f * CHANNELS + c] = v;
+            csvBytes += snprintf(line, sizeof(line), "%u,%d,%.4f\n", t, c,
+                                 v * 0.125);
+        }
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    ADS1115LogWriter writer(ADS1115LogWriter::fileSink, file);
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    writer.begin(channels, CHANNELS);
+    for (long f = 0; f < frames; f++) {
+        writer.append(&samples[f * CHANNELS], (uint32_t)(f * 1163));
+    }
+    writer.flush();
+    double encode = seconds(start);
+    fclose(file);
+
+    printf("%ld frames x %d channels\n", frames, CHANNELS);
+    printf("log %u bytes in %u blocks (%.2f bytes/sample), CSV %llu bytes "
+           "(%.1fx)\n", writer.getByteCount(), writer.getBlockCount(),
+           (double)writer.getByteCount() / samples.size(),
+           (unsigned long long)csvBytes,
+           (double)csvBytes / writer.getByteCount());
+    printf("encode %.1f Msamples/s\n", samples.size() / encode / 1e6);
+
+    ADS1115LogReader reader;
+    start = std::chrono::steady_clock::now();
+    if (!reader.open(path)) {
+        printf("cannot open %s\n", path);
+        return 1;
+    }
+    printf("index %zu blocks in %.2f ms\n", reader.getBlockCount(),
+           seconds(start) * 1e3);
+
+    size_t blocks = reader.getBlockCount();
+    std::vector<int16_t> decoded(reader.getSampleCount(0, blocks));
+    bool ok = decoded.size() == samples.size();
+    for (unsigned threads = 1; ok && threads <= 8; threads *= 2) {
+        start = std::chrono::steady_clock::now();
+        size_t good = reader.decodeBlocks(0, blocks, decoded.data(), threads);
+        double t = seconds(start);
+        ok = good == blocks && decoded == samples;
+        printf("decode %u thread%s %.1f Msamples/s\n", threads,
+               threads > 1 ? "s" : "", decoded.size() / t / 1e6);
+    }
+
+    // Random time lookups: bisect, then decode the one covering block
+    std::vector<int16_t> one(ADS1115_LOG_BUFFER_SIZE);
+    const int lookups = 10000;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; ok && i < lookups; i++) {
+        uint64_t when = (uint64_t)(rand() % frames) * 1163;
+        size_t b = reader.findBlock(when);
+        ok = b < blocks && reader.getBlock(b).firstUs <= when &&
+             reader.decodeBlock(b, one.data());
+    }
+    printf("time lookup + block decode %.2f us\n",
+           seconds(start) / lookups * 1e6);
+
+    printf("%s\n", ok ? "round trip OK" : "FAILED");
+    remove(path);
+    return ok ? 0 : 1;
+}
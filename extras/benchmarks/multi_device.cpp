@@ -0,0 +1,73 @@
+// Simulated-bus benchmark: aggregate sample rate of ADS1115Coordinator as
+// devices are added to one bus (4 single-ended channels each, 860 SPS),
+// against scanning the same devices one after the other.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -DADS1115_BUS_SIM -I../../src -o multi_device
+//       multi_device.cpp ../../src/*.cpp
+//   ./multi_device [scans]
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "ADS1115.h"
+#include "ADS1115Coordinator.h"
+
+static const ADS1115ScanChannel channels[4] = {
+    { ADS1115_MUX_P0_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P1_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P2_NG, ADS1115_PGA_2P048 },
+    { ADS1115_MUX_P3_NG, ADS1115_PGA_1P024 }
+};
+
+int main(int argc, char **argv)
+{
+    int scans = argc > 1 ? atoi(argv[1]) : 200;
+    const uint8_t addresses[4] = {
+        ADS1115_ADDRESS_ADDR_GND, ADS1115_ADDRESS_ADDR_VDD,
+        ADS1115_ADDRESS_ADDR_SDA, ADS1115_ADDRESS_ADDR_SCL
+    };
+
+    printf("devices  channels  sequential SPS  coordinated SPS  "
+           "latency min/mean/max us\n");
+    for (uint8_t n = 1; n <= 4; n++) {
+        ADS1115SimBus bus;
+        ADS1115SimDevice *sims[4];
+        ADS1115 *adcs[4];
+        ADS1115Coordinator coordinator;
+        int16_t out[16];
+
+        for (uint8_t i = 0; i < n; i++) {
+            sims[i] = new ADS1115SimDevice(addresses[i]);
+            bus.attach(*sims[i]);
+            adcs[i] = new ADS1115(bus, addresses[i]);
+            adcs[i]->initialize();
+            adcs[i]->setRate(ADS1115_RATE_860);
+            coordinator.add(*adcs[i], channels, 4);
+        }
+
+        uint32_t start = bus.micros();
+        for (int s = 0; s < scans; s++) {
+            for (uint8_t i = 0; i < n; i++) {
+                adcs[i]->scan(channels, 4, out + 4 * i);
+            }
+        }
+        double sequential = scans * 4.0 * n / ((bus.micros() - start) / 1e6);
+
+        start = bus.micros();
+        for (int s = 0; s < scans; s++) {
+            coordinator.scan(out);
+        }
+        double coordinated = scans * 4.0 * n / ((bus.micros() - start) / 1e6);
+
+        const ADS1115LatencyStats &lat = coordinator.getLatency(0, 1);
+        printf("%7u  %8u  %14.0f  %15.0f  %u/%u/%u\n", n, 4 * n, sequential,
+               coordinated, lat.min, lat.total / lat.count, lat.max);
+
+        for (uint8_t i = 0; i < n; i++) {
+            delete adcs[i];
+            delete sims[i];
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Simulated-bus benchmark: ADS1115Service throughput as buses and
+// post-processing threads are added. Every bus carries four devices with
+// four single-ended channels each; each block goes through a 32-tap FIR per
+// channel to stand in for filtering and encoding. Simulated buses run as
+// fast as the CPU allows, so the numbers show how sampling and
+// post-processing scale across cores, not real I2C rates.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -pthread -DADS1115_BUS_SIM -I../../src -o service
+//       service.cpp ../../src/*.cpp
+//   ./service [milliseconds per run]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "ADS1115.h"
+#include "ADS1115Service.h"
+
+#define TAPS    32
+
+static const ADS1115ScanChannel channels[4] = {
+    { ADS1115_MUX_P0_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P1_NG, ADS1115_PGA_4P096 },
+    { ADS1115_MUX_P2_NG, ADS1115_PGA_2P048 },
+    { ADS1115_MUX_P3_NG, ADS1115_PGA_1P024 }
+};
+
+// Stateless stand-in for per-block work: a FIR over a synthetic history
+static void filter(ADS1115ServiceBlock &block, void *)
+{
+    for (uint8_t c = 0; c < block.count; c++) {
+        int64_t acc = 0;
+        for (int t = 0; t < TAPS; t++) {
+            acc += (int64_t)(block.value[c] + t * 7) * (TAPS - t);
+        }
+        block.value[c] = (int32_t)(acc / (TAPS * (TAPS + 1) / 2));
+    }
+}
+
+struct Rig {
+    std::vector<ADS1115SimBus *> buses;
+    std::vector<ADS1115SimDevice *> sims;
+    std::vector<ADS1115 *> adcs;
+
+    ~Rig()
+    {
+        for (size_t i = 0; i < adcs.size(); i++) delete adcs[i];
+        for (size_t i = 0; i < sims.size(); i++) delete sims[i];
+        for (size_t i = 0; i < buses.size(); i++) delete buses[i];
+    }
+};
+
+int main(int argc, char **argv)
+{
+    int ms = argc > 1 ? atoi(argv[1]) : 500;
+    const uint8_t addresses[4] = {
+        ADS1115_ADDRESS_ADDR_GND, ADS1115_ADDRESS_ADDR_VDD,
+        ADS1115_ADDRESS_ADDR_SDA, ADS1115_ADDRESS_ADDR_SCL
+    };
+    const uint8_t busCounts[] = { 1, 2, 4 };
+    const uint8_t workerCounts[] = { 1, 2, 4, 8 };
+    static ADS1115ServiceBlock blocks[1024];
+
+    printf("cores %u\n", std::thread::hardware_concurrency());
+    printf("buses  workers  scans/s    blocks/s   steals/s  overruns\n");
+    for (uint8_t nb : busCounts) {
+        for (uint8_t nw : workerCounts) {
+            Rig rig;
+            ADS1115Service service(nw);
+
+            for (uint8_t b = 0; b < nb; b++) {
+                ADS1115SimBus *bus = new ADS1115SimBus();
+                rig.buses.push_back(bus);
+                int8_t index = service.addBus();
+                for (uint8_t d = 0; d < 4; d++) {
+                    ADS1115SimDevice *sim = new ADS1115SimDevice(addresses[d]);
+                    bus->attach(*sim);
+                    ADS1115 *adc = new ADS1115(*bus, addresses[d]);
+                    adc->initialize();
+                    adc->setRate(ADS1115_RATE_860);
+                    service.add(index, *adc, channels, 4);
+                    rig.sims.push_back(sim);
+                    rig.adcs.push_back(adc);
+                }
+            }
+            service.setProcessor(filter, 0);
+
+            uint64_t received = 0;
+            std::chrono::steady_clock::time_point begin =
+                std::chrono::steady_clock::now();
+            std::chrono::steady_clock::time_point end =
+                begin + std::chrono::milliseconds(ms);
+            service.start();
+            while (std::chrono::steady_clock::now() < end) {
+                size_t got = service.read(blocks, 1024);
+                received += got;
+                if (!got) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+            service.stop();
+            received += service.read(blocks, 1024);
+            double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - begin).count();
+
+            uint64_t scans = 0;
+            for (uint8_t b = 0; b < nb; b++) {
+                scans += service.getScans(b);
+            }
+            printf("%5u  %7u  %9.0f  %9.0f  %8.0f  %8u\n", nb, nw,
+                   scans / seconds, service.getProcessed() / seconds,
+                   service.getSteals() / seconds, service.getOverruns());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Host-side reader for ADS1115FrameSender output: decodes packets from a
+// serial port, a capture file or stdin and prints one CSV line per frame
+// (timestamp in us, then one raw sample per channel). Link statistics go
+// to stderr at the end.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -pthread -I../../src -o frame_dump
+//       frame_dump.cpp ../../src/*.cpp
+//   stty -F /dev/ttyACM0 115200 raw && ./frame_dump /dev/ttyACM0
+
+#include <cstdio>
+
+#include "ADS1115Frame.h"
+
+int main(int argc, char **argv)
+{
+    FILE *in = argc > 1 ? fopen(argv[1], "rb") : stdin;
+    ADS1115FrameDecoder decoder;
+    uint8_t chunk[256];
+    size_t len;
+
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    while ((len = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        size_t at = 0;
+        while (at < len) {
+            bool ready;
+            at += decoder.feed(chunk + at, len - at, ready);
+            if (!ready) {
+                continue;
+            }
+            for (uint8_t f = 0; f < decoder.getFrameCount(); f++) {
+                printf("%lu", (unsigned long)decoder.getFrameTimestamp(f));
+                for (uint8_t c = 0; c < decoder.getChannelCount(); c++) {
+                    printf(",%d", decoder.getSample(f, c));
+                }
+                printf("\n");
+            }
+        }
+    }
+    fprintf(stderr, "%lu packets, %lu lost, %lu resyncs, %lu CRC errors, "
+            "%lu bytes skipped\n", (unsigned long)decoder.getPackets(),
+            (unsigned long)decoder.getLostPackets(),
+            (unsigned long)decoder.getResyncs(),
+            (unsigned long)decoder.getCrcErrors(),
+            (unsigned long)decoder.getSkippedBytes());
+    return 0;
+}
@@ -1,14 +1,22 @@
+#if defined(ARDUINO)
 #include "Arduino.h"
-
-#ifndef _BV
-#define _BV(x)  (1<<(x))
 #endif
 
-#include <Wire.h>
 #include "ADS1115.h"
 
+#if defined(ADS1115_BUS_WIRE)
+static ADS1115WireBus wireBus;
+#endif
+
+// Instrumentation hook: the statement only exists with ADS1115_STATS
+#ifdef ADS1115_STATS
+#define ADS1115_STAT(statement)     statement
+#else
+#define ADS1115_STAT(statement)
+#endif
+
 
-/** Specific address constructor.
+/** Specific address constructor, on the shared Wire transport.
  * @param address I2C address
  * @see ADS1115_DEFAULT_ADDRESS
  * @see ADS1115_ADDRESS_ADDR_GND
@@ -16,9 +24,44 @@
  * @see ADS1115_ADDRESS_ADDR_SDA
  * @see ADS1115_ADDRESS_ADDR_SDL
  */
-ADS1115::ADS1115(uint8_t address) {
-    Wire.begin();
+#if defined(ADS1115_BUS_WIRE)
+ADS1115::ADS1115(uint8_t address) : ADS1115(wireBus, address) {
+}
+#endif
+
+/** Specific bus and address constructor.
+ * @param bus I2C transport the device is attached to
+ * @param address I2C address
+ * @see ADS1115_BUS_WIRE
+ * @see ADS1115_BUS_LINUX
+ * @see ADS1115_BUS_SIM
+ */
+ADS1115::ADS1115(ADS1115Bus &bus, uint8_t address) {
+    this->bus = &bus;
+    this->bus->begin();
     devAddr = address;
+    pointerReg = ADS1115_RA_UNKNOWN;
+    lastStatus = ADS1115_STATUS_OK;
+    busStatus = ADS1115_STATUS_OK;
+    conversionStart = 0;
+    conversionId = 0;
+    transactionCount = 0;
+    readyRing = 0;
+    readyBusy = false;
+    readyMissed = 0;
+    readyErrors = 0;
+    eventBand = 0;
+    verifyOnRead = false;
+    configDeferred = false;
+    configDirty = false;
+    calibration = 0;
+    calKey = 0xFF;
+    ADS1115_STAT(stats.reset());
+    configValue = ADS1115_CFG_RESET;    // until the device is read
+    loThreshValue = 0x8000;
+    hiThreshValue = 0x7FFF;
+    decodeConfig();
+    invalidate();
 }
 
 /** Power on and prepare for general usage.
@@ -30,6 +73,8 @@ ADS1115::ADS1115(uint8_t address) {
 void ADS1115::initialize()
 {
     configValue = 0;
+    configCached = true;
+    beginConfig();
     setMultiplexer(ADS1115_MUX_P0_N1);
     setGain(ADS1115_PGA_2P048);
     setMode(ADS1115_MODE_SINGLESHOT);
@@ -38,17 +83,48 @@ void ADS1115::initialize()
     setComparatorPolarity(ADS1115_COMP_POL_ACTIVE_LOW);
     setComparatorLatchEnabled(ADS1115_COMP_LAT_NON_LATCHING);
     setComparatorQueueMode(ADS1115_COMP_QUE_DISABLE);
+    commit();
+}
+
+/** Start a CONFIG transaction.
+ * Until commit(), setters only edit the shadow CONFIG value; nothing is
+ * written and the continuous-mode stop/start in setMultiplexer()/setGain()
+ * is skipped. commit() then sends the whole register in one write.
+ * @see commit()
+ */
+void ADS1115::beginConfig()
+{
+    cachedConfig();
+    configDeferred = true;
+}
+
+/** End a CONFIG transaction, writing the register once if any setter ran.
+ * In continuous mode the device picks the new settings up from the next
+ * conversion on; the result in flight when commit() lands may still use the
+ * old ones, so discard one sample if that matters.
+ * @see beginConfig()
+ */
+void ADS1115::commit()
+{
+    configDeferred = false;
+    if (configDirty) {
+        configDirty = false;
+        writeConfig();
+    }
 }
 
 /** Verify the I2C connection.
- * Make sure the device is connected and responds as expected.
+ * Make sure the device is connected and responds as expected. Reads one
+ * byte of whatever register the pointer is on, which changes nothing;
+ * many I2C adapters refuse the zero-length write of a plain address probe.
  * @return True if connection is valid, false otherwise
  */
 bool ADS1115::testConnection()
 {
-    Wire.beginTransmission(devAddr);
-    int status = Wire.endTransmission();
-    return status == 0;
+    uint8_t probe;
+
+    transactionCount++;
+    return bus->read(devAddr, &probe, 1) == 1;
 }
 
 /** Poll the operational status bit until the conversion is finished
@@ -60,32 +136,158 @@ bool ADS1115::testConnection()
 bool ADS1115::pollConversion(uint16_t max_retries)
 {
     for (uint16_t i = 0; i < max_retries; i++) {
+        ADS1115_STAT(stats.pollIterations++);
         if (isConversionReady()) {
+            ADS1115_STAT(statReady(conversionStart));
             return true;
         }
     }
+    ADS1115_STAT(stats.pollTimeouts++);
     return false;
 }
 
+/** Wait for the conversion started by the last trigger to finish.
+ * Sleeps until the nominal conversion time for the configured data rate has
+ * passed, then confirms with a single CONFIG poll. If the oscillator runs
+ * slow, polls again with exponential backoff (1/32 up to 1/8 of the
+ * conversion time) until the worst-case time allowed by
+ * ADS1115_OSC_TOLERANCE_PCT has passed. A poll the device does not answer
+ * ends the wait at once.
+ * @return ADS1115_STATUS_OK when ready, ADS1115_STATUS_TIMEOUT, or the bus
+ *         status (e.g. ADS1115_STATUS_NACK) of a failed poll
+ * @see getConversionTime()
+ * @see ADS1115_OSC_TOLERANCE_PCT
+ */
+uint8_t ADS1115::waitForConversion()
+{
+    uint8_t rate = (cachedConfig() & ADS1115_CFG_DR_MASK) >>
+                   ADS1115_CFG_DR_SHIFT;
+    uint32_t nominal = getConversionTime(rate) + ADS1115_WAKEUP_US;
+    uint32_t limit = nominal + nominal * ADS1115_OSC_TOLERANCE_PCT / 100;
+    uint32_t backoff = nominal / 32;
+    uint32_t elapsed = bus->micros() - conversionStart;
+
+    if (elapsed < nominal) {
+        bus->sleepMicros(nominal - elapsed);
+    }
+    for (;;) {
+        ADS1115_STAT(stats.pollIterations++);
+        if (isConversionReady()) {
+            ADS1115_STAT(statReady(conversionStart));
+            lastStatus = ADS1115_STATUS_OK;
+            return lastStatus;
+        }
+        if (busStatus != ADS1115_STATUS_OK) {
+            lastStatus = busStatus;
+            return lastStatus;
+        }
+        elapsed = bus->micros() - conversionStart;
+        if (elapsed >= limit) {
+            ADS1115_STAT(stats.pollTimeouts++);
+            lastStatus = ADS1115_STATUS_TIMEOUT;
+            return lastStatus;
+        }
+        bus->sleepMicros(backoff < limit - elapsed ? backoff : limit - elapsed);
+        if (backoff < nominal / 8) {
+            backoff *= 2;
+        }
+    }
+}
+
+/** Get the outcome of the last conversion wait or read.
+ * @return ADS1115_STATUS_OK, ADS1115_STATUS_TIMEOUT or a bus status such
+ *         as ADS1115_STATUS_NACK
+ * @see waitForConversion()
+ */
+uint8_t ADS1115::getLastStatus()
+{
+    return lastStatus;
+}
+
+/** Get the outcome of the last register access on the bus.
+ * @return ADS1115_STATUS_OK, ADS1115_STATUS_NACK, ADS1115_STATUS_SHORT_READ
+ *         or ADS1115_STATUS_BUS_ERROR
+ */
+uint8_t ADS1115::getBusStatus()
+{
+    return busStatus;
+}
+
+/** Nominal conversion time for a data rate.
+ * @param rate Data rate
+ * @return Conversion time in microseconds
+ * @see ADS1115_RATE_8
+ */
+uint32_t ADS1115::getConversionTime(uint8_t rate)
+{
+    return ADS1115CFG::conversionTime(rate);
+}
+
+/** Read a 16-bit register.
+ * The device keeps the last pointer written, so when it already points at
+ * regAddr this is a single 2-byte read. Otherwise the pointer write and the
+ * read are joined by a repeated start. A failed transaction leaves the
+ * pointer state unknown so the next access rewrites it. The outcome is kept
+ * in busStatus: no bytes at all count as ADS1115_STATUS_NACK, one as
+ * ADS1115_STATUS_SHORT_READ.
+ * @param regAddr Register address
+ * @return Register value
+ * @see ADS1115_RA_UNKNOWN
+ */
 uint16_t ADS1115::readRegister(uint8_t regAddr)
 {
-    Wire.beginTransmission(devAddr);
-    Wire.write(regAddr);
-    Wire.endTransmission();
+    uint8_t data[2] = { 0, 0 };
+    uint8_t count;
 
-    delay(1);
+    transactionCount++;
+    ADS1115_STAT(stats.registerReads++);
+    if (pointerReg == regAddr) {
+        count = bus->read(devAddr, data, 2);
+    } else {
+        count = bus->writeRead(devAddr, &regAddr, 1, data, 2);
+    }
+    pointerReg = (count == 2) ? regAddr : ADS1115_RA_UNKNOWN;
+    busStatus = count == 2 ? ADS1115_STATUS_OK :
+                count == 0 ? ADS1115_STATUS_NACK : ADS1115_STATUS_SHORT_READ;
+    ADS1115_STAT(if (busStatus == ADS1115_STATUS_NACK) {
+                     stats.nacks++;
+                 } else if (busStatus == ADS1115_STATUS_SHORT_READ) {
+                     stats.shortReads++;
+                 });
 
-    Wire.requestFrom(devAddr, (uint8_t)2);
-    return ((Wire.read() << 8) | Wire.read());
+    return ((data[0] << 8) | data[1]);
 }
 
+/** Write a 16-bit register. Leaves the device pointer at regAddr, and the
+ * outcome in busStatus.
+ * @param regAddr Register address
+ * @param value New register value
+ */
 void ADS1115::writeRegister(uint8_t regAddr, uint16_t value)
 {
-    Wire.beginTransmission(devAddr);
-    Wire.write(regAddr);
-    Wire.write((value & 0xFF00) >> 8);
-    Wire.write(value & 0x00FF);
-    Wire.endTransmission();
+    uint8_t data[3];
+    uint8_t status;
+
+    data[0] = regAddr;
+    data[1] = (value & 0xFF00) >> 8;
+    data[2] = value & 0x00FF;
+    transactionCount++;
+    ADS1115_STAT(stats.registerWrites++);
+    status = bus->write(devAddr, data, 3);
+    if (status == ADS1115_BUS_OK) {
+        pointerReg = regAddr;
+        busStatus = ADS1115_STATUS_OK;
+    } else {
+        pointerReg = ADS1115_RA_UNKNOWN;
+        busStatus = status == ADS1115_BUS_ERROR ? ADS1115_STATUS_BUS_ERROR :
+                    ADS1115_STATUS_NACK;
+        ADS1115_STAT(if (status == ADS1115_BUS_NACK_ADDR ||
+                         status == ADS1115_BUS_NACK_DATA) {
+                         stats.nacks++;
+                     } else {
+                         stats.busErrors++;
+                     });
+    }
 }
 
 /** Read differential value based on current MUX configuration.
@@ -105,7 +307,9 @@ void ADS1115::writeRegister(uint8_t regAddr, uint16_t value)
  *
  * @param triggerAndPoll If true (and only in singleshot mode) the conversion trigger
  *        will be executed and the conversion results will be polled.
- * @return 16-bit signed differential value
+ * @return 16-bit signed differential value (stale if getLastStatus() reports
+ *         a timeout, 0 if the device did not answer)
+ * @see waitForConversion()
  * @see getConversionP0N1();
  * @see getConversionPON3();
  * @see getConversionP1N3();
@@ -127,12 +331,135 @@ void ADS1115::writeRegister(uint8_t regAddr, uint16_t value)
  */
 int16_t ADS1115::getConversion(bool triggerAndPoll)
 {
-    if (triggerAndPoll && devMode == ADS1115_MODE_SINGLESHOT) {
+    bool waited;
+    int16_t value;
+
+    if (triggerAndPoll) {
+        cachedConfig();     // the mode decides whether to trigger
+        if (!configCached) {
+            lastStatus = busStatus;
+            return 0;
+        }
+    }
+    waited = triggerAndPoll && devMode == ADS1115_MODE_SINGLESHOT;
+    if (waited) {
         triggerConversion();
-        pollConversion(1000);
+        if (busStatus == ADS1115_STATUS_OK) {
+            waitForConversion();
+        } else {
+            lastStatus = busStatus;
+        }
+        if (lastStatus != ADS1115_STATUS_OK &&
+            lastStatus != ADS1115_STATUS_TIMEOUT) {
+            return 0;
+        }
+    } else {
+        lastStatus = ADS1115_STATUS_OK;
+    }
+
+    value = (int16_t)(readRegister(ADS1115_RA_CONVERSION));
+    if (busStatus != ADS1115_STATUS_OK) {
+        lastStatus = busStatus;
     }
+    ADS1115_STAT(if (waited && lastStatus == ADS1115_STATUS_OK) {
+                     statRead(conversionStart);
+                 });
+    return value;
+}
+
+/** Read conversions through a filter until it produces an output.
+ * In single-shot mode every sample is triggered and waited for. In
+ * continuous mode the bus sleeps one conversion period plus the oscillator
+ * tolerance before each read, so even a slow device has a new result ready
+ * every time; a fast one just skips a conversion now and then.
+ * A decimator therefore turns e.g. 860 SPS into up to 860/R outputs per
+ * second, with uncorrelated noise cut by about sqrt(R) and fractional bits
+ * kept.
+ * @param filter Filter for the current channel (keep one per channel)
+ * @return Filtered value, counts << ADS1115_FILTER_FRAC_BITS; 0 if a
+ *         conversion timed out or the bus failed, and getLastStatus() says
+ *         why. The filter keeps the samples it took before the failure, so
+ *         the next call carries on from them.
+ * @see ADS1115Filter::toMicroVolts()
+ */
+int32_t ADS1115::getFilteredConversion(ADS1115Filter &filter)
+{
+    uint8_t rate = (cachedConfig() & ADS1115_CFG_DR_MASK) >>
+                   ADS1115_CFG_DR_SHIFT;
+    uint32_t period = getConversionTime(rate);
+    int32_t out = 0;
+    int16_t raw;
+
+    if (!configCached) {
+        lastStatus = busStatus;
+        return 0;
+    }
+    period += period * ADS1115_OSC_TOLERANCE_PCT / 100;
+    do {
+        if (devMode == ADS1115_MODE_SINGLESHOT) {
+            raw = getConversion(true);
+        } else {
+            bus->sleepMicros(period);
+            raw = getConversion(false);
+        }
+        if (lastStatus != ADS1115_STATUS_OK) {
+            return 0;
+        }
+    } while (!filter.push(raw, out));
+    return out;
+}
+
+/** Single-shot conversion of an auto-ranged input.
+ * The input's MUX and chosen PGA go out with the OS bit in one CONFIG
+ * write, the result is scaled for that PGA, and the PGA for the input's
+ * next conversion is picked from it. Clipped readings are returned flagged
+ * rather than retried; the next conversion runs at a wider range.
+ * @param range Ranging state of the input (keep one per input)
+ * @return Reading in uV; status is ADS1115_STATUS_TIMEOUT if the
+ *         conversion never finished, or the bus status if the device did
+ *         not answer (CONFIG read back, trigger or result), in which case
+ *         the range is unchanged
+ * @see ADS1115AutoRange::update()
+ */
+ADS1115RangedReading ADS1115::getAutoRanged(ADS1115AutoRange &range)
+{
+    ADS1115ScanChannel channel;
+    ADS1115RangedReading reading;
+    int16_t raw;
+    uint16_t base = (cachedConfig() & ~(ADS1115_CFG_MUX_MASK |
+                                        ADS1115_CFG_PGA_MASK)) |
+                    ADS1115_CFG_MODE_BIT;
 
-    return (int16_t)(readRegister(ADS1115_RA_CONVERSION));
+    channel.mux = range.getMux();
+    channel.pga = range.getGain();
+    reading.microVolts = 0;
+    reading.raw = 0;
+    reading.pga = channel.pga;
+    reading.flags = 0;
+    if (!configCached) {
+        lastStatus = busStatus;
+        reading.status = lastStatus;
+        return reading;
+    }
+    setConfig(scanConfig(base, channel) | ADS1115_CFG_OS_BIT);
+    if (busStatus != ADS1115_STATUS_OK) {
+        invalidate();
+        lastStatus = busStatus;
+        reading.status = lastStatus;
+        return reading;
+    }
+    if (waitForConversion() != ADS1115_STATUS_OK) {
+        reading.status = lastStatus;
+        return reading;
+    }
+    raw = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+    if (busStatus != ADS1115_STATUS_OK) {
+        lastStatus = busStatus;
+        reading.status = lastStatus;
+        return reading;
+    }
+    ADS1115_STAT(statRead(conversionStart));
+    return range.update(raw);
 }
 
 /** Get AIN0/N1 differential.
@@ -255,6 +582,628 @@ int16_t ADS1115::getConversionP3GND()
     return getConversion();
 }
 
+/** Start a single-shot conversion and return immediately.
+ * MUX, PGA and rate go out with the OS bit in one CONFIG write; other
+ * settings are kept. Only one conversion can be in flight per device, so
+ * starting another makes older handles report ADS1115_STATUS_STALE.
+ * @param mux MUX setting
+ * @param pga PGA setting
+ * @param rate Data rate
+ * @return Handle to pass to poll(); its status is already the bus status
+ *         (e.g. ADS1115_STATUS_NACK) if CONFIG could not be read back or
+ *         the trigger was not accepted
+ * @see poll()
+ */
+ADS1115Conversion ADS1115::startConversion(uint8_t mux, uint8_t pga,
+                                           uint8_t rate)
+{
+    ADS1115Conversion conversion;
+    uint16_t config = cachedConfig() & ~(ADS1115_CFG_MUX_MASK |
+                                         ADS1115_CFG_PGA_MASK |
+                                         ADS1115_CFG_DR_MASK);
+
+    conversion.nominal = getConversionTime(rate) + ADS1115_WAKEUP_US;
+    conversion.pollAt = conversion.nominal;
+    conversion.backoff = conversion.nominal / 32;
+    conversion.value = 0;
+    // Never trigger with a guessed CONFIG; busStatus says why
+    if (!configCached) {
+        conversion.id = conversionId;
+        conversion.started = bus->micros();
+        conversion.status = busStatus;
+        return conversion;
+    }
+    config |= ADS1115_CFG_MODE_BIT |
+              ((mux << ADS1115_CFG_MUX_SHIFT) & ADS1115_CFG_MUX_MASK) |
+              ((pga << ADS1115_CFG_PGA_SHIFT) & ADS1115_CFG_PGA_MASK) |
+              ((rate << ADS1115_CFG_DR_SHIFT) & ADS1115_CFG_DR_MASK);
+    setConfig(config | ADS1115_CFG_OS_BIT);
+
+    conversion.id = ++conversionId;
+    conversion.started = conversionStart;
+    conversion.status = ADS1115_STATUS_PENDING;
+    if (busStatus != ADS1115_STATUS_OK) {
+        invalidate();
+        conversion.status = busStatus;
+    }
+    return conversion;
+}
+
+/** Advance a split-phase conversion without blocking.
+ * Does nothing on the bus until the conversion is due; then checks the OS
+ * bit once per call, backing off exponentially (1/32 up to 1/8 of the
+ * conversion time) if the oscillator runs slow, and reads the result as
+ * soon as it is ready. A status poll or result read the device does not
+ * answer ends the conversion with that bus status.
+ * @param conversion Handle from startConversion(); updated in place
+ * @return ADS1115_STATUS_PENDING, ADS1115_STATUS_OK,
+ *         ADS1115_STATUS_TIMEOUT, ADS1115_STATUS_STALE or a bus status
+ *         (ADS1115_STATUS_NACK, _SHORT_READ, _BUS_ERROR)
+ * @see startConversion()
+ */
+uint8_t ADS1115::poll(ADS1115Conversion &conversion)
+{
+    uint32_t elapsed, limit;
+
+    if (conversion.status != ADS1115_STATUS_PENDING) {
+        return conversion.status;
+    }
+    if (conversion.id != conversionId) {
+        conversion.status = ADS1115_STATUS_STALE;
+        return conversion.status;
+    }
+    elapsed = bus->micros() - conversion.started;
+    if (elapsed < conversion.pollAt) {
+        return ADS1115_STATUS_PENDING;
+    }
+    ADS1115_STAT(stats.pollIterations++);
+    if (isConversionReady()) {
+        ADS1115_STAT(statReady(conversion.started));
+        conversion.value = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+        conversion.status = busStatus;
+        if (busStatus != ADS1115_STATUS_OK) {
+            conversion.value = 0;
+        }
+        ADS1115_STAT(if (busStatus == ADS1115_STATUS_OK) {
+                         statRead(conversion.started);
+                     });
+        return conversion.status;
+    }
+    if (busStatus != ADS1115_STATUS_OK) {
+        conversion.status = busStatus;
+        return conversion.status;
+    }
+    limit = conversion.nominal +
+            conversion.nominal * ADS1115_OSC_TOLERANCE_PCT / 100;
+    if (elapsed >= limit) {
+        ADS1115_STAT(stats.pollTimeouts++);
+        conversion.status = ADS1115_STATUS_TIMEOUT;
+        return conversion.status;
+    }
+    conversion.pollAt = elapsed + conversion.backoff;
+    if (conversion.pollAt > limit) {
+        conversion.pollAt = limit;
+    }
+    if (conversion.backoff < conversion.nominal / 8) {
+        conversion.backoff *= 2;
+    }
+    return ADS1115_STATUS_PENDING;
+}
+
+/** Read the current input within a time budget.
+ * In single-shot mode this triggers a conversion and waits for it like
+ * getConversion(true), but gives up once the budget would be exceeded and
+ * reports bus failures instead of returning garbage: a device that does not
+ * answer the trigger fails after that one transaction. In continuous mode
+ * it is a single read of the latest result.
+ * @param budgetMicros Time allowed for the whole call, bus traffic included
+ * @return Raw value and ADS1115_STATUS_OK, ADS1115_STATUS_TIMEOUT,
+ *         ADS1115_STATUS_NACK, ADS1115_STATUS_SHORT_READ or
+ *         ADS1115_STATUS_BUS_ERROR
+ * @see readChannel()
+ */
+ADS1115Result ADS1115::readConversion(uint32_t budgetMicros)
+{
+    ADS1115Result result;
+
+    // With a stale shadow the mode is not known yet; convertWithin() loads
+    // it on the budget's clock
+    if (!configCached || (configValue & ADS1115_CFG_MODE_BIT)) {
+        return convertWithin(0, budgetMicros);
+    }
+    result.value = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+    result.status = busStatus;
+    lastStatus = result.status;
+    return result;
+}
+
+/** Convert one input in single-shot mode within a time budget.
+ * MUX, PGA and the trigger go out in one CONFIG write; other settings are
+ * kept. Same bounds and statuses as readConversion(), so a loop over
+ * several inputs has a known worst case per input even when a device
+ * drops off the bus.
+ * @param channel MUX/PGA to convert
+ * @param budgetMicros Time allowed for the whole call, bus traffic included
+ * @return Raw value and status
+ * @see readConversion()
+ */
+ADS1115Result ADS1115::readChannel(const ADS1115ScanChannel &channel,
+                                   uint32_t budgetMicros)
+{
+    return convertWithin(&channel, budgetMicros);
+}
+
+/** Trigger a single-shot conversion and collect it before the deadline.
+ * A budget shorter than the fastest possible conversion fails at once
+ * without touching the bus. Otherwise the clock starts before a stale
+ * CONFIG shadow is reloaded, and the trigger write is timed to price the
+ * accesses still to come: each is taken to cost a third more than the
+ * write, which covers the pointer write + read of the result (one more
+ * byte and a repeated start). A poll is only started while there is still
+ * room for it and the result read, so on a working bus the call ends
+ * within the budget. Polls follow waitForConversion(): the first at the
+ * nominal conversion time, then with exponential backoff.
+ * Without a channel, a device found in continuous mode is read once.
+ */
+ADS1115Result ADS1115::convertWithin(const ADS1115ScanChannel *channel,
+                                     uint32_t budgetMicros)
+{
+    ADS1115Result result;
+    uint16_t config;
+    uint8_t rate;
+    uint32_t nominal, limit, backoff, started, access, last, elapsed, wait;
+
+    started = bus->micros();
+    result.value = 0;
+    result.status = ADS1115_STATUS_TIMEOUT;
+    nominal = getConversionTime(ADS1115_RATE_860) + ADS1115_WAKEUP_US;
+    if (budgetMicros < nominal - nominal * ADS1115_OSC_TOLERANCE_PCT / 100) {
+        lastStatus = result.status;
+        return result;
+    }
+
+    config = cachedConfig();
+    if (!configCached) {
+        result.status = busStatus;
+        lastStatus = result.status;
+        return result;
+    }
+    if (!channel && !(config & ADS1115_CFG_MODE_BIT)) {
+        result.value = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+        result.status = busStatus;
+        lastStatus = result.status;
+        return result;
+    }
+    config |= ADS1115_CFG_MODE_BIT;
+    if (channel) {
+        config = scanConfig(config & ~(ADS1115_CFG_MUX_MASK |
+                                       ADS1115_CFG_PGA_MASK), *channel);
+    }
+    rate = (config & ADS1115_CFG_DR_MASK) >> ADS1115_CFG_DR_SHIFT;
+    nominal = getConversionTime(rate) + ADS1115_WAKEUP_US;
+    limit = nominal + nominal * ADS1115_OSC_TOLERANCE_PCT / 100;
+    backoff = nominal / 32;
+
+    elapsed = bus->micros() - started;
+    if (budgetMicros < elapsed + nominal -
+                       nominal * ADS1115_OSC_TOLERANCE_PCT / 100) {
+        lastStatus = result.status;
+        return result;
+    }
+
+    access = bus->micros();
+    setConfig(config | ADS1115_CFG_OS_BIT);
+    if (busStatus != ADS1115_STATUS_OK) {
+        invalidate();
+        result.status = busStatus;
+        lastStatus = result.status;
+        return result;
+    }
+    access = bus->micros() - access;
+    access += access / 3;
+    elapsed = bus->micros() - started;
+    nominal += elapsed;             // the conversion starts after the write
+    limit += elapsed;
+    last = budgetMicros > 2 * access ? budgetMicros - 2 * access : 0;
+    if (last > limit) {
+        last = limit;
+    }
+
+    wait = nominal - elapsed;
+    for (;;) {
+        if (elapsed + wait > last) {
+            if (elapsed >= last) {
+                ADS1115_STAT(stats.pollTimeouts++);
+                break;
+            }
+            wait = last - elapsed;
+        }
+        bus->sleepMicros(wait);
+        ADS1115_STAT(stats.pollIterations++);
+        if (isConversionReady()) {
+            ADS1115_STAT(statReady(conversionStart));
+            result.value = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+            result.status = busStatus;
+            ADS1115_STAT(if (busStatus == ADS1115_STATUS_OK) {
+                             statRead(conversionStart);
+                         });
+            break;
+        }
+        if (busStatus != ADS1115_STATUS_OK) {
+            result.status = busStatus;
+            break;
+        }
+        elapsed = bus->micros() - started;
+        wait = backoff;
+        if (backoff < nominal / 8) {
+            backoff *= 2;
+        }
+    }
+    lastStatus = result.status;
+    return result;
+}
+
+/** Convert a list of channels back to back in single-shot mode.
+ * Each step waits for the conversion in flight, then writes the next
+ * channel's CONFIG with OS set and only afterwards reads the finished
+ * result. The CONVERSION register keeps the previous result until the new
+ * conversion completes, so the read overlaps the next conversion instead of
+ * adding to it: n channels cost n config writes, n reads and the polls.
+ * Rate and comparator settings are taken from the current configuration;
+ * the device is left in single-shot mode on the last channel.
+ * @param channels MUX/PGA pairs to convert, in order
+ * @param count Number of channels
+ * @param out Raw results, one per channel
+ * @return Number of channels converted; on a timeout or bus failure the
+ *         channels before it, with getLastStatus() saying why
+ * @see ADS1115ScanChannel
+ */
+uint8_t ADS1115::scan(const ADS1115ScanChannel *channels, uint8_t count,
+                      int16_t *out)
+{
+    uint16_t base;
+
+    if (count == 0) {
+        return 0;
+    }
+    base = (cachedConfig() & ~(ADS1115_CFG_MUX_MASK | ADS1115_CFG_PGA_MASK)) |
+           ADS1115_CFG_MODE_BIT;
+    if (!configCached) {
+        lastStatus = busStatus;
+        return 0;
+    }
+
+    setConfig(scanConfig(base, channels[0]) | ADS1115_CFG_OS_BIT);
+    if (busStatus != ADS1115_STATUS_OK) {
+        invalidate();
+        lastStatus = busStatus;
+        return 0;
+    }
+    for (uint8_t i = 1; i < count; i++) {
+        if (waitForConversion() != ADS1115_STATUS_OK) {
+            return i - 1;
+        }
+        ADS1115_STAT(uint32_t started = conversionStart);
+        setConfig(scanConfig(base, channels[i]) | ADS1115_CFG_OS_BIT);
+        if (busStatus != ADS1115_STATUS_OK) {
+            invalidate();
+            lastStatus = busStatus;
+            return i - 1;
+        }
+        out[i - 1] = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+        if (busStatus != ADS1115_STATUS_OK) {
+            lastStatus = busStatus;
+            return i - 1;
+        }
+        ADS1115_STAT(statRead(started));
+    }
+    if (waitForConversion() != ADS1115_STATUS_OK) {
+        return count - 1;
+    }
+    out[count - 1] = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+    if (busStatus != ADS1115_STATUS_OK) {
+        lastStatus = busStatus;
+        return count - 1;
+    }
+    ADS1115_STAT(statRead(conversionStart));
+    return count;
+}
+
+#if defined(ADS1115_BUS_LINUX)
+/** Queue a single-shot trigger for one channel into a batch.
+ * The CONFIG shadow follows at once; if the batch then fails, call
+ * invalidate() before relying on it. The conversion start time is taken
+ * when the batch is submitted.
+ * @param batch Batch on this device's bus
+ * @param channel MUX/PGA to convert; other settings are kept
+ * @return False if the batch is full, or if CONFIG is stale and could not
+ *         be read back (getBusStatus() says why)
+ * @see ADS1115Batch::submit()
+ */
+bool ADS1115::queueTrigger(ADS1115Batch &batch,
+                           const ADS1115ScanChannel &channel)
+{
+    uint16_t config = scanConfig((cachedConfig() & ~(ADS1115_CFG_MUX_MASK |
+                                                     ADS1115_CFG_PGA_MASK)) |
+                                 ADS1115_CFG_MODE_BIT, channel);
+
+    if (!configCached) {
+        return false;
+    }
+    if (!batch.writeRegister(devAddr, ADS1115_RA_CONFIG,
+                             config | ADS1115_CFG_OS_BIT, &conversionStart)) {
+        return false;
+    }
+    configValue = config;
+    configCached = true;
+    configDirty = false;
+    decodeConfig();
+    pointerReg = ADS1115_RA_UNKNOWN;    // settled only once the batch is sent
+    transactionCount++;
+    ADS1115_STAT(stats.registerWrites++);
+    return true;
+}
+
+/** Queue a read of the CONFIG register into a batch, e.g. to check the OS
+ * bit of a conversion read in the same batch.
+ * @param batch Batch on this device's bus
+ * @param config Receives CONFIG (with OS) after a successful submit()
+ * @return False if the batch is full
+ */
+bool ADS1115::queueStatus(ADS1115Batch &batch, uint16_t *config)
+{
+    if (!batch.readRegister(devAddr, ADS1115_RA_CONFIG, config)) {
+        return false;
+    }
+    pointerReg = ADS1115_RA_UNKNOWN;
+    transactionCount++;
+    ADS1115_STAT(stats.registerReads++);
+    return true;
+}
+
+/** Queue a read of the conversion register into a batch.
+ * The pointer byte is always sent, as it costs no extra syscall.
+ * @param batch Batch on this device's bus
+ * @param value Receives the raw result after a successful submit()
+ * @return False if the batch is full
+ */
+bool ADS1115::queueConversion(ADS1115Batch &batch, int16_t *value)
+{
+    if (!batch.readRegister(devAddr, ADS1115_RA_CONVERSION,
+                            (uint16_t *)value)) {
+        return false;
+    }
+    pointerReg = ADS1115_RA_UNKNOWN;
+    transactionCount++;
+    ADS1115_STAT(stats.registerReads++);
+    return true;
+}
+#endif
+
+/** CONFIG value for one scan entry on top of the shared base settings.
+ */
+uint16_t ADS1115::scanConfig(uint16_t base, const ADS1115ScanChannel &channel)
+{
+    return base |
+           ((channel.mux << ADS1115_CFG_MUX_SHIFT) & ADS1115_CFG_MUX_MASK) |
+           ((channel.pga << ADS1115_CFG_PGA_SHIFT) & ADS1115_CFG_PGA_MASK);
+}
+
+/** Start continuous conversions with ALERT/RDY pulsing after each one.
+ * From here on, call onConversionReady() on every falling RDY edge (from the
+ * pin interrupt, a GPIO event thread, ...) and drain the ring from the main
+ * loop. The device pointer is parked on CONVERSION, so each edge costs a
+ * single 2-byte read. Don't call other methods while acquisition runs; the
+ * edge handler owns the bus until endReadyAcquisition().
+ * @param ring Destination for raw conversion results
+ * @return False if the device did not take the settings; the edge handler
+ *         then stays disarmed and getBusStatus() says why
+ * @see onConversionReady()
+ * @see setConversionReadyPinMode()
+ */
+bool ADS1115::beginReadyAcquisition(ADS1115Ring<int16_t> &ring)
+{
+    readyRing = 0;
+    readyMissed = 0;
+    readyErrors = 0;
+    beginConfig();
+    setConversionReadyPinMode();
+    setMode(ADS1115_MODE_CONTINUOUS);
+    commit();
+    if (!configCached || !loThreshCached || !hiThreshCached) {
+        return false;
+    }
+    readRegister(ADS1115_RA_CONVERSION);
+    if (busStatus != ADS1115_STATUS_OK) {
+        return false;
+    }
+    readyRing = &ring;
+    return true;
+}
+
+/** Stop ALERT/RDY acquisition and return to single-shot mode.
+ */
+void ADS1115::endReadyAcquisition()
+{
+    readyRing = 0;
+    setMode(ADS1115_MODE_SINGLESHOT);
+}
+
+/** Handle one conversion-ready edge: read the result and queue it.
+ * Safe to call from an interrupt handler as long as the I2C driver works
+ * there (on AVR, mask the pin's own interrupt and then re-enable
+ * interrupts, so Wire's TWI interrupt can run but the handler cannot nest;
+ * see examples/ADS1115_interrupt). An edge that arrives while the previous
+ * read is still in progress is counted by getMissedReadyEdges() instead of
+ * nesting, and a read that fails on the bus by getReadyReadErrors()
+ * instead of being queued.
+ * @return True if a sample was queued; a full ring counts an overrun
+ * @see beginReadyAcquisition()
+ */
+bool ADS1115::onConversionReady()
+{
+    bool stored = false;
+    int16_t value;
+
+    if (!readyRing) {
+        return false;
+    }
+    if (readyBusy) {
+        readyMissed = readyMissed + 1;
+        return false;
+    }
+    readyBusy = true;
+    value = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+    if (busStatus == ADS1115_STATUS_OK) {
+        stored = readyRing->push(value);
+    } else {
+        readyErrors = readyErrors + 1;
+    }
+    readyBusy = false;
+    return stored;
+}
+
+/** Number of RDY (or ALERT) edges dropped because a read was already in
+ * progress.
+ * Samples dropped because the ring was full are reported by the ring.
+ * @return Missed edge count since beginReadyAcquisition() or
+ *         beginComparatorEvents()
+ * @see ADS1115Ring::getOverruns()
+ */
+uint32_t ADS1115::getMissedReadyEdges()
+{
+    return readyMissed;
+}
+
+/** Number of RDY (or ALERT) edges whose result read failed on the bus
+ * (NACK, short read, bus error); nothing was queued for them.
+ * @return Failed reads since beginReadyAcquisition() or
+ *         beginComparatorEvents()
+ */
+uint32_t ADS1115::getReadyReadErrors()
+{
+    return readyErrors;
+}
+
+/** Watch one input with the comparator and only talk to the device when
+ * it reports an excursion.
+ * Sets the thresholds (at the current gain and rate), a latching comparator
+ * in the given mode and continuous conversions, then parks the pointer on
+ * CONVERSION. From here on the device converts and compares on its own;
+ * call onComparatorAlert() on every ALERT edge (falling, with the default
+ * active-low polarity) and drain the ring from the main loop. In window mode
+ * ALERT fires when a result leaves [low, high]; in hysteresis mode when it
+ * rises above high. The comparator queue setting is kept if one is
+ * configured, otherwise every out-of-range result asserts ALERT.
+ * As with beginReadyAcquisition(), the edge handler owns the bus until
+ * endComparatorEvents().
+ * @param ring Destination for the results that raised ALERT
+ * @param mux Input to watch
+ * @param lowMicroVolts Low threshold in uV
+ * @param highMicroVolts High threshold in uV
+ * @param mode ADS1115_COMP_MODE_WINDOW or ADS1115_COMP_MODE_HYSTERESIS
+ * @return False if the device did not take the settings; the alert handler
+ *         then stays disarmed and getBusStatus() says why
+ * @see setEventDeadband()
+ * @see setThresholdsMicroVolts()
+ */
+bool ADS1115::beginComparatorEvents(ADS1115Ring<int16_t> &ring, uint8_t mux,
+                                    int32_t lowMicroVolts,
+                                    int32_t highMicroVolts, uint8_t mode)
+{
+    readyRing = 0;
+    readyMissed = 0;
+    readyErrors = 0;
+    beginConfig();
+    setMultiplexer(mux);
+    setComparatorMode(mode);
+    setComparatorLatchEnabled(ADS1115_COMP_LAT_LATCHING);
+    if ((cachedConfig() & ADS1115_CFG_COMP_QUE_MASK) ==
+        (ADS1115_COMP_QUE_DISABLE << ADS1115_CFG_COMP_QUE_SHIFT)) {
+        setComparatorQueueMode(ADS1115_COMP_QUE_ASSERT1);
+    }
+    setMode(ADS1115_MODE_CONTINUOUS);
+    setThresholdsMicroVolts(lowMicroVolts, highMicroVolts);
+    commit();
+    if (!configCached || !loThreshCached || !hiThreshCached) {
+        return false;
+    }
+    readRegister(ADS1115_RA_CONVERSION);
+    if (busStatus != ADS1115_STATUS_OK) {
+        return false;
+    }
+    readyRing = &ring;
+    return true;
+}
+
+/** Re-centre the window on every result that raised ALERT.
+ * With a deadband, onComparatorAlert() moves the thresholds to the result
+ * +/- the deadband, so ALERT next fires only once the input has moved that
+ * far again: slowly drifting inputs report changes, not every sample.
+ * Without one (the default) the thresholds stay put and ALERT keeps
+ * firing on each result while the input is out of range. Meant for window
+ * mode; uses the current gain.
+ * @param microVolts Window half-width in uV, 0 for fixed thresholds
+ */
+void ADS1115::setEventDeadband(uint32_t microVolts)
+{
+    cachedConfig();
+    eventBand = ADS1115CFG::counts(microVolts > 8000000 ? 8000000 :
+                                   (int32_t)microVolts, pgaMode);
+}
+
+/** Handle one ALERT edge: read the result, which releases the latched
+ * ALERT, queue it, and re-arm around it if a deadband is set.
+ * Same interrupt rules as onConversionReady(); a failed read is counted by
+ * getReadyReadErrors() and neither queued nor re-armed around. The read
+ * costs one 2-byte transaction; re-arming adds two threshold writes.
+ * @return True if a result was queued; a full ring counts an overrun
+ * @see beginComparatorEvents()
+ */
+bool ADS1115::onComparatorAlert()
+{
+    bool stored;
+    int16_t value;
+
+    if (!readyRing) {
+        return false;
+    }
+    if (readyBusy) {
+        readyMissed = readyMissed + 1;
+        return false;
+    }
+    readyBusy = true;
+    value = (int16_t)readRegister(ADS1115_RA_CONVERSION);
+    if (busStatus != ADS1115_STATUS_OK) {
+        // Nothing to queue or re-centre on. A latched ALERT stays asserted,
+        // so calling this again while the pin is low retries the read
+        readyErrors = readyErrors + 1;
+        readyBusy = false;
+        return false;
+    }
+    stored = readyRing->push(value);
+    if (eventBand) {
+        setLowThreshold(ADS1115CFG::clampCounts((int32_t)value - eventBand));
+        setHighThreshold(ADS1115CFG::clampCounts((int32_t)value + eventBand));
+    }
+    readyBusy = false;
+    return stored;
+}
+
+/** Stop threshold events: disable the comparator (ALERT goes inactive) and
+ * return to single-shot mode.
+ */
+void ADS1115::endComparatorEvents()
+{
+    readyRing = 0;
+    beginConfig();
+    setComparatorLatchEnabled(ADS1115_COMP_LAT_NON_LATCHING);
+    setComparatorQueueMode(ADS1115_COMP_QUE_DISABLE);
+    setMode(ADS1115_MODE_SINGLESHOT);
+    commit();
+}
+
+#ifndef ADS1115_NO_FLOAT
 /** Get the current voltage reading
  * Read the current differential and return it multiplied
  * by the constant for the current gain.  mV is returned to
@@ -264,6 +1213,9 @@ int16_t ADS1115::getConversionP3GND()
  */
 float ADS1115::getMilliVolts(bool triggerAndPoll) {
     int16_t reading = getConversion(triggerAndPoll);
+    if (calibration) {
+        return (float)calibrated().apply(reading) * 0.001f;
+    }
     float factor = getMvPerCount();
     return (float)reading * factor;
 }
@@ -272,58 +1224,127 @@ float ADS1115::getMilliVolts(bool triggerAndPoll) {
  * Return the current multiplier for the PGA setting.
  *
  * This may be directly retreived by using getMilliVolts(),
- * but this causes an independent read.  This function could
- * be used to average a number of reads from the getConversion()
- * getConversionx() functions and cut downon the number of
- * floating-point calculations needed.
+ * but this causes an independent read. To average readings, feed
+ * raw results to an ADS1115Filter (see getFilteredConversion()) and
+ * scale once at the end instead of summing floats.
  *
  */
 
 float ADS1115::getMvPerCount() {
-    switch (pgaMode) {
-        case ADS1115_PGA_6P144:
-            return ADS1115_MV_6P144;
-        case ADS1115_PGA_4P096:
-            return  ADS1115_MV_4P096;
-        case ADS1115_PGA_2P048:
-            return ADS1115_MV_2P048;
-        case ADS1115_PGA_1P024:
-            return ADS1115_MV_1P024;
-        case ADS1115_PGA_0P512:
-            return ADS1115_MV_0P512;
-        case ADS1115_PGA_0P256:
-        case ADS1115_PGA_0P256B:
-        case ADS1115_PGA_0P256C:
-            return ADS1115_MV_0P256;
-        default:
-            return 0.0;
+    return ADS1115CFG::mvPerCount(pgaMode);
+}
+#endif /* ADS1115_NO_FLOAT */
+
+/** Get the current voltage reading in microvolts.
+ * Integer-only counterpart of getMilliVolts(): exact for every PGA setting
+ * (rounded to the nearest uV) and free of soft-float on AVR.
+ * @param triggerAndPoll If true (and only in singleshot mode) the conversion trigger
+ *        will be executed and the conversion results will be polled.
+ * @return Input voltage in uV
+ * @see toMicroVolts()
+ */
+int32_t ADS1115::getMicroVolts(bool triggerAndPoll)
+{
+    int16_t reading = getConversion(triggerAndPoll);
+    if (calibration) {
+        return calibrated().apply(reading);
     }
+    return ADS1115CFG::microVolts(reading, pgaMode);
 }
 
-uint16_t ADS1115::getFullScale(uint8_t pga)
+/** Apply offset/gain corrections in getMicroVolts() and getMilliVolts().
+ * The fused coefficients of the current MUX/PGA are looked up once per
+ * change of either, not per sample. Call again after changing the table.
+ * @param calibration Table to use, or 0 for nominal scaling
+ */
+void ADS1115::setCalibration(const ADS1115Calibration *calibration)
 {
-    switch (pga) {
-        case ADS1115_PGA_6P144:
-            return ADS1115_FSR_6P144;
-        case ADS1115_PGA_4P096:
-            return ADS1115_FSR_4P096;
-        case ADS1115_PGA_2P048:
-            return ADS1115_FSR_2P048;
-        case ADS1115_PGA_1P024:
-            return ADS1115_FSR_1P024;
-        case ADS1115_PGA_0P512:
-            return ADS1115_FSR_0P512;
-        case ADS1115_PGA_0P256:
-        case ADS1115_PGA_0P256B:
-        case ADS1115_PGA_0P256C:
-            return ADS1115_FSR_0P256;
-        default:
-            return 0;
+    this->calibration = calibration;
+    calKey = 0xFF;
+}
+
+/** Coefficients for the current MUX/PGA, nominal if uncalibrated.
+ */
+const ADS1115CalCoeff &ADS1115::calibrated()
+{
+    uint8_t key = (muxMode << 3) | pgaMode;
+
+    if (key != calKey) {
+        const ADS1115CalCoeff *coeff = calibration->find(muxMode, pgaMode);
+        calCoeff = coeff ? *coeff : ADS1115Calibration::nominal(pgaMode);
+        calKey = key;
     }
+    return calCoeff;
+}
+
+/** Convert a buffer of raw counts taken at one PGA setting to microvolts.
+ * @param raw Raw conversion results
+ * @param out Destination, count entries
+ * @param count Number of samples
+ * @param pga PGA setting the samples were taken with
+ * @see getMicroVolts()
+ */
+void ADS1115::toMicroVolts(const int16_t *raw, int32_t *out, uint16_t count,
+                           uint8_t pga)
+{
+    uint16_t mul = ADS1115CFG::Tables::uvMul[pga & 0x07];
+    uint8_t shift = ADS1115CFG::Tables::uvShift[pga & 0x07];
+    int32_t round = (1 << shift) >> 1;
+
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = ((int32_t)raw[i] * mul + round) >> shift;
+    }
+}
+
+/** Full-scale range of a PGA setting.
+ * @param pga PGA setting
+ * @return Full-scale range in mV
+ * @see ADS1115_PGA_6P144
+ */
+uint16_t ADS1115::getFullScale(uint8_t pga)
+{
+    return ADS1115CFG::fullScale(pga);
 }
 
 // CONFIG register
 
+/** Get the whole CONFIG register (OS bit clear).
+ * @return Current CONFIG value
+ * @see ADS1115_RA_CONFIG
+ */
+uint16_t ADS1115::getConfig()
+{
+    return readConfig();
+}
+
+/** Replace the whole CONFIG register in one write.
+ * Pairs with ADS1115CFG::Config<...>::value so a complete configuration is
+ * a compile-time constant. The OS bit is honoured for this write only, so
+ * Config<...>::trigger starts a single-shot conversion with the new settings.
+ * Inside a beginConfig() transaction a value with OS set is still written
+ * at once, which commits the pending settings along with the trigger; the
+ * transaction stays open for the setters after it.
+ * @param config New CONFIG value
+ * @see ADS1115CFG::Config
+ * @see ADS1115_RA_CONFIG
+ */
+void ADS1115::setConfig(uint16_t config)
+{
+    configValue = config & ~ADS1115_CFG_OS_BIT;
+    configCached = true;
+    decodeConfig();
+    if (configDeferred && !(config & ADS1115_CFG_OS_BIT)) {
+        configDirty = true;
+    } else {
+        configDirty = false;
+        writeRegister(ADS1115_RA_CONFIG, config);
+        configCached = busStatus == ADS1115_STATUS_OK;
+        if (config & ADS1115_CFG_OS_BIT) {
+            conversionStart = bus->micros();
+        }
+    }
+}
+
 /** Get operational status.
  * @return Current operational status (false for active conversion, true for inactive)
  * @see ADS1115_RA_CONFIG
@@ -331,19 +1352,28 @@ uint16_t ADS1115::getFullScale(uint8_t pga)
  */
 bool ADS1115::isConversionReady()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readRegister(ADS1115_RA_CONFIG);  // OS is never cached
     return !(!(value & ADS1115_CFG_OS_BIT));
 }
 
 /** Trigger a new conversion.
  * Writing to this bit will only have effect while in power-down mode (no conversions active).
+ * Nothing is written if CONFIG is stale and cannot be read back; getBusStatus()
+ * then says why.
  * @see ADS1115_RA_CONFIG
  * @see ADS1115_CFG_OS_BIT
  */
 void ADS1115::triggerConversion()
 {
-    configValue |= ADS1115_CFG_OS_BIT;
-    writeRegister(ADS1115_RA_CONFIG, configValue);
+    uint16_t config = cachedConfig();
+
+    // Never trigger with a guessed CONFIG; busStatus says why
+    if (!configCached) {
+        return;
+    }
+    configDirty = false;    // the trigger carries any pending settings
+    writeRegister(ADS1115_RA_CONFIG, config | ADS1115_CFG_OS_BIT);
+    conversionStart = bus->micros();
 }
 
 /** Get multiplexer connection.
@@ -354,7 +1384,7 @@ void ADS1115::triggerConversion()
  */
 uint8_t ADS1115::getMultiplexer()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     muxMode = (uint8_t)((value & ADS1115_CFG_MUX_MASK) >>
                          ADS1115_CFG_MUX_SHIFT);
     return muxMode;
@@ -378,11 +1408,12 @@ uint8_t ADS1115::getMultiplexer()
  */
 void ADS1115::setMultiplexer(uint8_t mux)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_MUX_MASK;
     configValue |= (mux << ADS1115_CFG_MUX_SHIFT) & ADS1115_CFG_MUX_MASK;
-    writeRegister(ADS1115_RA_CONFIG, configValue);
+    writeConfig();
     muxMode = mux;
-    if (devMode == ADS1115_MODE_CONTINUOUS) {
+    if (!configDeferred && devMode == ADS1115_MODE_CONTINUOUS) {
         // Force a stop/start
         setMode(ADS1115_MODE_SINGLESHOT);
         getConversion();
@@ -398,7 +1429,7 @@ void ADS1115::setMultiplexer(uint8_t mux)
  */
 uint8_t ADS1115::getGain()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     pgaMode = (uint8_t)((value & ADS1115_CFG_PGA_MASK) >>
                          ADS1115_CFG_PGA_SHIFT);
     return pgaMode;
@@ -421,11 +1452,12 @@ uint8_t ADS1115::getGain()
  */
 void ADS1115::setGain(uint8_t gain)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_PGA_MASK;
     configValue |= (gain << ADS1115_CFG_PGA_SHIFT) & ADS1115_CFG_PGA_MASK;
-    writeRegister(ADS1115_RA_CONFIG, configValue);
+    writeConfig();
     pgaMode = gain;
-    if (devMode == ADS1115_MODE_CONTINUOUS) {
+    if (!configDeferred && devMode == ADS1115_MODE_CONTINUOUS) {
         // Force a stop/start
         setMode(ADS1115_MODE_SINGLESHOT);
         getConversion();
@@ -442,7 +1474,7 @@ void ADS1115::setGain(uint8_t gain)
  */
 uint8_t ADS1115::getMode()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     devMode = (uint8_t)!(!(value & ADS1115_CFG_MODE_BIT));
     return devMode;
 }
@@ -456,11 +1488,12 @@ uint8_t ADS1115::getMode()
  */
 void ADS1115::setMode(uint8_t mode)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_MODE_BIT;
     if (mode) {
         configValue |= ADS1115_CFG_MODE_BIT;
     }
-    writeRegister(ADS1115_RA_CONFIG, configValue);
+    writeConfig();
     devMode = mode;
 }
 
@@ -472,7 +1505,7 @@ void ADS1115::setMode(uint8_t mode)
  */
 uint8_t ADS1115::getRate()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     return (uint8_t)((value & ADS1115_CFG_DR_MASK) >> ADS1115_CFG_DR_SHIFT);
 }
 
@@ -492,9 +1525,10 @@ uint8_t ADS1115::getRate()
  */
 void ADS1115::setRate(uint8_t rate)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_DR_MASK;
     configValue |= (rate << ADS1115_CFG_DR_SHIFT) & ADS1115_CFG_DR_MASK;
-    writeRegister(ADS1115_RA_CONFIG, configValue);
+    writeConfig();
 }
 
 /** Get comparator mode.
@@ -506,7 +1540,7 @@ void ADS1115::setRate(uint8_t rate)
  */
 uint8_t ADS1115::getComparatorMode()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     return (uint8_t)!(!(value & ADS1115_CFG_COMP_MODE_BIT));
 }
 
@@ -519,10 +1553,12 @@ uint8_t ADS1115::getComparatorMode()
  */
 void ADS1115::setComparatorMode(uint8_t mode)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_COMP_MODE_BIT;
     if (mode) {
         configValue |= ADS1115_CFG_COMP_MODE_BIT;
     }
+    writeConfig();
 }
 
 /** Get comparator polarity setting.
@@ -534,7 +1570,7 @@ void ADS1115::setComparatorMode(uint8_t mode)
  */
 uint8_t ADS1115::getComparatorPolarity()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     return (uint8_t)!(!(value & ADS1115_CFG_COMP_POL_BIT));
 }
 
@@ -547,10 +1583,12 @@ uint8_t ADS1115::getComparatorPolarity()
  */
 void ADS1115::setComparatorPolarity(uint8_t polarity)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_COMP_POL_BIT;
     if (polarity) {
         configValue |= ADS1115_CFG_COMP_POL_BIT;
     }
+    writeConfig();
 }
 
 /** Get comparator latch enabled value.
@@ -562,7 +1600,7 @@ void ADS1115::setComparatorPolarity(uint8_t polarity)
  */
 uint8_t ADS1115::getComparatorLatchEnabled()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     return (uint8_t)!(!(value & ADS1115_CFG_COMP_LAT_BIT));
 }
 
@@ -575,10 +1613,12 @@ uint8_t ADS1115::getComparatorLatchEnabled()
  */
 void ADS1115::setComparatorLatchEnabled(uint8_t enabled)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_COMP_LAT_BIT;
     if (enabled) {
         configValue |= ADS1115_CFG_COMP_LAT_BIT;
     }
+    writeConfig();
 }
 
 /** Get comparator queue mode.
@@ -593,7 +1633,7 @@ void ADS1115::setComparatorLatchEnabled(uint8_t enabled)
  */
 uint8_t ADS1115::getComparatorQueueMode()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
+    uint16_t value = readConfig();
     return (uint8_t)((value & ADS1115_CFG_COMP_QUE_MASK) >>
                       ADS1115_CFG_COMP_QUE_SHIFT);
 }
@@ -610,10 +1650,11 @@ uint8_t ADS1115::getComparatorQueueMode()
  */
 void ADS1115::setComparatorQueueMode(uint8_t mode)
 {
+    cachedConfig();
     configValue &= ~ADS1115_CFG_COMP_QUE_MASK;
     configValue |= (mode << ADS1115_CFG_COMP_QUE_SHIFT) &
                    ADS1115_CFG_COMP_QUE_MASK;
-    writeRegister(ADS1115_RA_CONFIG, configValue);
+    writeConfig();
 }
 
 // *_THRESH registers
@@ -624,7 +1665,15 @@ void ADS1115::setComparatorQueueMode(uint8_t mode)
  */
 int16_t ADS1115::getLowThreshold()
 {
-    return (int16_t)readRegister(ADS1115_RA_LO_THRESH);
+    if (!loThreshCached || verifyOnRead) {
+        uint16_t value = readRegister(ADS1115_RA_LO_THRESH);
+
+        loThreshCached = busStatus == ADS1115_STATUS_OK;
+        if (loThreshCached) {
+            loThreshValue = value;
+        }
+    }
+    return (int16_t)loThreshValue;
 }
 
 /** Set low threshold value.
@@ -634,6 +1683,8 @@ int16_t ADS1115::getLowThreshold()
 void ADS1115::setLowThreshold(int16_t threshold)
 {
     writeRegister(ADS1115_RA_LO_THRESH, (uint16_t)threshold);
+    loThreshValue = (uint16_t)threshold;
+    loThreshCached = busStatus == ADS1115_STATUS_OK;
 }
 
 /** Get high threshold value.
@@ -642,7 +1693,15 @@ void ADS1115::setLowThreshold(int16_t threshold)
  */
 int16_t ADS1115::getHighThreshold()
 {
-    return (int16_t)readRegister(ADS1115_RA_HI_THRESH);
+    if (!hiThreshCached || verifyOnRead) {
+        uint16_t value = readRegister(ADS1115_RA_HI_THRESH);
+
+        hiThreshCached = busStatus == ADS1115_STATUS_OK;
+        if (hiThreshCached) {
+            hiThreshValue = value;
+        }
+    }
+    return (int16_t)hiThreshValue;
 }
 
 /** Set high threshold value.
@@ -652,6 +1711,33 @@ int16_t ADS1115::getHighThreshold()
 void ADS1115::setHighThreshold(int16_t threshold)
 {
     writeRegister(ADS1115_RA_HI_THRESH, (uint16_t)threshold);
+    hiThreshValue = (uint16_t)threshold;
+    hiThreshCached = busStatus == ADS1115_STATUS_OK;
+}
+
+/** Set both thresholds from voltages at the current PGA.
+ * Values beyond full scale clip to the end of the range, like readings do.
+ * Set the gain first; the thresholds are compared with raw counts, so they
+ * have to be set again after a gain change.
+ * @param low Low threshold in uV
+ * @param high High threshold in uV
+ * @see ADS1115CFG::counts()
+ */
+void ADS1115::setThresholdsMicroVolts(int32_t low, int32_t high)
+{
+    cachedConfig();
+    setLowThreshold(ADS1115CFG::counts(low, pgaMode));
+    setHighThreshold(ADS1115CFG::counts(high, pgaMode));
+}
+
+/** Set both thresholds from voltages at the current PGA.
+ * @param low Low threshold in mV
+ * @param high High threshold in mV
+ * @see setThresholdsMicroVolts()
+ */
+void ADS1115::setThresholdsMilliVolts(int16_t low, int16_t high)
+{
+    setThresholdsMicroVolts((int32_t)low * 1000, (int32_t)high * 1000);
 }
 
 /** Configures ALERT/RDY pin as a conversion ready pin.
@@ -667,15 +1753,151 @@ void ADS1115::setConversionReadyPinMode()
     setComparatorQueueMode(0);
 }
 
+// Shadow registers
+
+/** Refresh the shadow copies of CONFIG, LO_THRESH and HI_THRESH from the
+ * device. Getters are served from these copies until invalidate() is called.
+ * Does nothing while a beginConfig() transaction is open, as reloading
+ * CONFIG would throw away the edits not yet committed.
+ * @see invalidate()
+ * @see verify()
+ */
+void ADS1115::sync()
+{
+    if (configDeferred) {
+        return;
+    }
+    configCached = false;
+    loThreshCached = false;
+    hiThreshCached = false;
+    readConfig();
+    getLowThreshold();
+    getHighThreshold();
+}
+
+/** Drop the shadow copies, e.g. after another master or a power cycle touched
+ * the device. The next getter or setter reloads from the bus.
+ * @see sync()
+ */
+void ADS1115::invalidate()
+{
+    configCached = false;
+    loThreshCached = false;
+    hiThreshCached = false;
+}
+
+/** Compare the shadow copies against the device and reload them.
+ * The OS bit is ignored since it reflects conversion state, not settings.
+ * @return True if every cached register matched the device; false if any
+ *         of the reads failed (getBusStatus() says why) or a beginConfig()
+ *         transaction is open
+ * @see sync()
+ */
+bool ADS1115::verify()
+{
+    bool match = true;
+    uint16_t config = configValue;
+    uint16_t lo = loThreshValue;
+    uint16_t hi = hiThreshValue;
+    bool hadConfig = configCached;
+    bool hadLo = loThreshCached;
+    bool hadHi = hiThreshCached;
+
+    if (configDeferred) {
+        return false;
+    }
+    sync();
+    if (!configCached || !loThreshCached || !hiThreshCached) {
+        return false;
+    }
+    if (hadConfig && config != configValue) {
+        match = false;
+    }
+    if (hadLo && lo != loThreshValue) {
+        match = false;
+    }
+    if (hadHi && hi != hiThreshValue) {
+        match = false;
+    }
+    return match;
+}
+
+/** Serve every getter from the device instead of the shadow copies.
+ * Each read also refreshes the shadow. Useful while bringing up a board.
+ * @param enabled True to read through to the device
+ */
+void ADS1115::setVerifyOnRead(bool enabled)
+{
+    verifyOnRead = enabled;
+}
+
+/** Current CONFIG value (without OS), from the shadow unless it is stale or
+ * verify-on-read is enabled. If the device does not answer, the last known
+ * value is returned and the shadow stays stale.
+ */
+uint16_t ADS1115::readConfig()
+{
+    if (!configCached || verifyOnRead) {
+        uint16_t value = readRegister(ADS1115_RA_CONFIG) & ~ADS1115_CFG_OS_BIT;
+
+        // A failed read leaves the shadow as it was, still marked stale
+        if (busStatus != ADS1115_STATUS_OK) {
+            configCached = false;
+            return configValue;
+        }
+        configValue = value;
+        configCached = true;
+        decodeConfig();
+    }
+    return configValue;
+}
+
+/** Refresh the cached MUX/PGA/MODE fields from the CONFIG shadow.
+ */
+void ADS1115::decodeConfig()
+{
+    muxMode = (uint8_t)((configValue & ADS1115_CFG_MUX_MASK) >>
+                        ADS1115_CFG_MUX_SHIFT);
+    pgaMode = (uint8_t)((configValue & ADS1115_CFG_PGA_MASK) >>
+                        ADS1115_CFG_PGA_SHIFT);
+    devMode = (uint8_t)!(!(configValue & ADS1115_CFG_MODE_BIT));
+}
+
+/** Current CONFIG shadow, loading it from the device only if stale.
+ * Setters use this so they never clobber fields they don't own.
+ */
+uint16_t ADS1115::cachedConfig()
+{
+    if (!configCached) {
+        readConfig();
+    }
+    return configValue;
+}
+
+/** Write the CONFIG shadow to the device, or just mark it dirty while a
+ * beginConfig()/commit() transaction is open.
+ */
+void ADS1115::writeConfig()
+{
+    if (configDeferred) {
+        configDirty = true;
+    } else {
+        writeRegister(ADS1115_RA_CONFIG, configValue);
+        if (busStatus != ADS1115_STATUS_OK) {
+            configCached = false;   // the device may not have it
+        }
+    }
+}
+
 /** Show all the config register settings
  */
 void ADS1115::showConfigRegister()
 {
-    uint16_t value = readRegister(ADS1115_RA_CONFIG);
-
 #ifdef ADS1115_SERIAL_DEBUG
+    uint16_t value = readRegister(ADS1115_RA_CONFIG);  // with OS, unshadowed
+
     Serial.print("Register is:");
-    Serial.println(configRegister, BIN);
+    Serial.println(value, BIN);
 
     Serial.print("OS:\t");
     Serial.println(!(!(value & ADS1115_CFG_OS_BIT)));
@@ -703,8 +1925,6 @@ void ADS1115::showConfigRegister()
 
     Serial.print("CMP_LAT:\t");
     Serial.println(!(!(value & ADS1115_CFG_COMP_LAT_BIT)));
-    Serial.println(getValueFromBits(configRegister,
-        ADS1115_CFG_COMP_LAT_BIT,1), BIN);
 
     Serial.print("CMP_QUE:\t");
     Serial.println((value & ADS1115_CFG_COMP_QUE_MASK) >>
@@ -712,4 +1932,68 @@ void ADS1115::showConfigRegister()
 #endif
 }
 
+/** Get the transport this device is attached to, e.g. for its clock.
+ * @return Bus reference
+ */
+ADS1115Bus &ADS1115::getBus()
+{
+    return *bus;
+}
+
+/** Get the number of bus transactions issued since construction or the last
+ * reset. A combined pointer write + read counts as one transaction.
+ * @return Transaction count
+ * @see resetTransactionCount()
+ */
+uint32_t ADS1115::getTransactionCount()
+{
+    return transactionCount;
+}
+
+/** Reset the bus transaction counter.
+ * @see getTransactionCount()
+ */
+void ADS1115::resetTransactionCount()
+{
+    transactionCount = 0;
+}
+
+#ifdef ADS1115_STATS
+/** Copy the hot-path counters and latency histograms.
+ * Only built with ADS1115_STATS; without it none of the counting code
+ * exists.
+ * @param snapshot Receives the statistics since construction or resetStats()
+ * @see ADS1115Stats
+ */
+void ADS1115::getStats(ADS1115Stats &snapshot)
+{
+    snapshot = stats;
+}
+
+/** Clear the hot-path counters and latency histograms.
+ * @see getStats()
+ */
+void ADS1115::resetStats()
+{
+    stats.reset();
+}
+
+/** Record a wait that saw the OS bit set.
+ * @param started bus->micros() at the trigger
+ */
+void ADS1115::statReady(uint32_t started)
+{
+    stats.conversions++;
+    stats.readyLatency.add(bus->micros() - started);
+}
+
+/** Record a result read of a conversion the driver waited for.
+ * @param started bus->micros() at the trigger
+ */
+void ADS1115::statRead(uint32_t started)
+{
+    stats.conversionLatency.add(bus->micros() - started);
+}
+#endif
+
 // vim:ts=4:sw=4:ai:et:si:sts=4
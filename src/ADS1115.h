@@ -3,11 +3,32 @@
 
 #include <inttypes.h>
 
+#ifndef _BV
+#define _BV(x)  (1<<(x))
+#endif
+
+#include "ADS1115Bus.h"
+#include "ADS1115CFG.h"
+#include "ADS1115Ring.h"
+#include "ADS1115Filter.h"
+#include "ADS1115AutoRange.h"
+#include "ADS1115Calibration.h"
+#include "ADS1115Stats.h"
+#if defined(ADS1115_BUS_LINUX)
+#include "ADS1115Batch.h"
+#endif
+
 // -----------------------------------------------------------------------------
 // Arduino-style "Serial.print" debug constant (uncomment to enable)
 // -----------------------------------------------------------------------------
 //#define ADS1115_SERIAL_DEBUG
 
+// -----------------------------------------------------------------------------
+// Hot-path counters and latency histograms (uncomment, or build with
+// -DADS1115_STATS, to enable; compiled out entirely otherwise)
+// -----------------------------------------------------------------------------
+//#define ADS1115_STATS
+
 #define ADS1115_ADDRESS_ADDR_GND    0x48 // address pin low (GND)
 #define ADS1115_ADDRESS_ADDR_VDD    0x49 // address pin high (VCC)
 #define ADS1115_ADDRESS_ADDR_SDA    0x4A // address pin tied to SDA pin
@@ -18,7 +39,9 @@
 #define ADS1115_RA_CONFIG           0x01
 #define ADS1115_RA_LO_THRESH        0x02
 #define ADS1115_RA_HI_THRESH        0x03
+#define ADS1115_RA_UNKNOWN          0xFF // pointer state not known
 
+#define ADS1115_CFG_RESET           0x0583 // power-on CONFIG, OS clear
 #define ADS1115_CFG_OS_BIT          _BV(15)
 #define ADS1115_CFG_MUX_MASK        (_BV(14) | _BV(13) | _BV(12))
 #define ADS1115_CFG_MUX_SHIFT       12
@@ -57,9 +80,9 @@
 #define ADS1115_MV_2P048            0.062500 // default
 #define ADS1115_MV_1P024            0.031250
 #define ADS1115_MV_0P512            0.015625
-#define ADS1115_MV_0P256            0.007813
-#define ADS1115_MV_0P256B           0.007813
-#define ADS1115_MV_0P256C           0.007813
+#define ADS1115_MV_0P256            0.0078125
+#define ADS1115_MV_0P256B           0.0078125
+#define ADS1115_MV_0P256C           0.0078125
 
 #define ADS1115_FSR_6P144            6144
 #define ADS1115_FSR_4P096            4096
@@ -94,22 +117,71 @@
 #define ADS1115_COMP_QUE_ASSERT4    0x02
 #define ADS1115_COMP_QUE_DISABLE    0x03 // default
 
-// -----------------------------------------------------------------------------
-// Arduino-style "Serial.print" debug constant (uncomment to enable)
-// -----------------------------------------------------------------------------
-//#define ADS1115_SERIAL_DEBUG
+#define ADS1115_STATUS_OK           0x00 // conversion ready / transfer done
+#define ADS1115_STATUS_TIMEOUT      0x01 // OS bit never came back
+#define ADS1115_STATUS_PENDING      0x02 // conversion still running
+#define ADS1115_STATUS_STALE        0x03 // superseded by a newer conversion
+#define ADS1115_STATUS_NACK         0x04 // device did not answer
+#define ADS1115_STATUS_SHORT_READ   0x05 // fewer bytes than requested
+#define ADS1115_STATUS_BUS_ERROR    0x06 // other transport failure
+
+// Internal oscillator accuracy (datasheet: +/-10%) and single-shot wake-up
+// time, used to bound how long a conversion may take.
+#ifndef ADS1115_OSC_TOLERANCE_PCT
+#define ADS1115_OSC_TOLERANCE_PCT   10
+#endif
+#define ADS1115_WAKEUP_US           25
+
+/** Handle of a split-phase conversion.
+ * Returned by ADS1115::startConversion() and advanced by ADS1115::poll();
+ * value is valid once status is ADS1115_STATUS_OK.
+ */
+struct ADS1115Conversion {
+    uint32_t id;
+    uint32_t started;       // bus clock at the trigger, us
+    uint32_t nominal;       // expected conversion time, us
+    uint32_t pollAt;        // next poll, us after started
+    uint32_t backoff;
+    int16_t  value;
+    uint8_t  status;
+};
+
+/** Outcome of a deadline-bounded read.
+ * value is valid only when status is ADS1115_STATUS_OK.
+ * @see ADS1115::readConversion()
+ */
+struct ADS1115Result {
+    int16_t value;
+    uint8_t status;
+};
 
+/** One entry of a scan list: which input to convert and at what gain.
+ * @see ADS1115::scan()
+ */
+struct ADS1115ScanChannel {
+    uint8_t mux;
+    uint8_t pga;
+};
 
 class ADS1115 {
     public:
+#if defined(ADS1115_BUS_WIRE)
         ADS1115(uint8_t address = ADS1115_DEFAULT_ADDRESS);
+#endif
+        ADS1115(ADS1115Bus &bus, uint8_t address = ADS1115_DEFAULT_ADDRESS);
 
         void initialize();
+        void beginConfig();
+        void commit();
         bool testConnection();
 
         // SINGLE SHOT utilities
         bool pollConversion(uint16_t max_retries);
         void triggerConversion();
+        uint8_t waitForConversion();
+        uint8_t getLastStatus();
+        uint8_t getBusStatus();
+        static uint32_t getConversionTime(uint8_t rate);
 
         // Read the current CONVERSION register
         int16_t getConversion(bool triggerAndPoll=true);
@@ -126,12 +198,61 @@ class ADS1115 {
         int16_t getConversionP2GND();
         int16_t getConversionP3GND();
 
+        int32_t getFilteredConversion(ADS1115Filter &filter);
+        ADS1115RangedReading getAutoRanged(ADS1115AutoRange &range);
+
+        // Split-phase (non-blocking) conversion
+        ADS1115Conversion startConversion(uint8_t mux, uint8_t pga,
+                                          uint8_t rate);
+        uint8_t poll(ADS1115Conversion &conversion);
+
+        // Deadline-bounded reads
+        ADS1115Result readConversion(uint32_t budgetMicros);
+        ADS1115Result readChannel(const ADS1115ScanChannel &channel,
+                                  uint32_t budgetMicros);
+
+        // Multi-channel scan
+        uint8_t scan(const ADS1115ScanChannel *channels, uint8_t count,
+                     int16_t *out);
+
+#if defined(ADS1115_BUS_LINUX)
+        // Batched I2C_RDWR
+        bool queueTrigger(ADS1115Batch &batch,
+                          const ADS1115ScanChannel &channel);
+        bool queueStatus(ADS1115Batch &batch, uint16_t *config);
+        bool queueConversion(ADS1115Batch &batch, int16_t *value);
+#endif
+
+        // ALERT/RDY driven acquisition
+        bool beginReadyAcquisition(ADS1115Ring<int16_t> &ring);
+        void endReadyAcquisition();
+        bool onConversionReady();
+        uint32_t getMissedReadyEdges();
+        uint32_t getReadyReadErrors();
+
+        // ALERT driven threshold events
+        bool beginComparatorEvents(ADS1115Ring<int16_t> &ring, uint8_t mux,
+                                   int32_t lowMicroVolts,
+                                   int32_t highMicroVolts,
+                                   uint8_t mode = ADS1115_COMP_MODE_WINDOW);
+        void setEventDeadband(uint32_t microVolts);
+        bool onComparatorAlert();
+        void endComparatorEvents();
+
         // Utility
+#ifndef ADS1115_NO_FLOAT
         float getMilliVolts(bool triggerAndPoll=true);
         float getMvPerCount();
+#endif
+        int32_t getMicroVolts(bool triggerAndPoll=true);
+        void setCalibration(const ADS1115Calibration *calibration);
+        static void toMicroVolts(const int16_t *raw, int32_t *out,
+                                 uint16_t count, uint8_t pga);
         uint16_t getFullScale(uint8_t pga);
 
         // CONFIG register
+        uint16_t getConfig();
+        void setConfig(uint16_t config);
         bool isConversionReady();
         uint8_t getMultiplexer();
         void setMultiplexer(uint8_t mux);
@@ -156,20 +277,75 @@ class ADS1115 {
         void setLowThreshold(int16_t threshold);
         int16_t getHighThreshold();
         void setHighThreshold(int16_t threshold);
+        void setThresholdsMicroVolts(int32_t low, int32_t high);
+        void setThresholdsMilliVolts(int16_t low, int16_t high);
+
+        // Shadow registers
+        void sync();
+        void invalidate();
+        bool verify();
+        void setVerifyOnRead(bool enabled);
+
+        ADS1115Bus &getBus();
 
         // DEBUG
         void showConfigRegister();
+        uint32_t getTransactionCount();
+        void resetTransactionCount();
+#ifdef ADS1115_STATS
+        void getStats(ADS1115Stats &snapshot);
+        void resetStats();
+#endif
 
     protected:
         uint16_t readRegister(uint8_t regaddr);
         void writeRegister(uint8_t regAddr, uint16_t value);
+        uint16_t readConfig();
+        uint16_t cachedConfig();
+        void decodeConfig();
+        void writeConfig();
+        const ADS1115CalCoeff &calibrated();
+        ADS1115Result convertWithin(const ADS1115ScanChannel *channel,
+                                    uint32_t budgetMicros);
+#ifdef ADS1115_STATS
+        void statReady(uint32_t started);
+        void statRead(uint32_t started);
+#endif
+        static uint16_t scanConfig(uint16_t base,
+                                   const ADS1115ScanChannel &channel);
 
     private:
+        ADS1115Bus *bus;
         uint8_t  devAddr;
+        uint8_t  pointerReg;
+        uint8_t  lastStatus;
+        uint8_t  busStatus;             // of the last register access
+        uint32_t conversionStart;
+        uint32_t conversionId;
+        uint32_t transactionCount;
+        ADS1115Ring<int16_t> *readyRing;
+        volatile bool readyBusy;
+        volatile uint32_t readyMissed;
+        volatile uint32_t readyErrors;
+        int16_t  eventBand;             // re-arm window half-width, 0 = fixed
         uint8_t  devMode;
         uint8_t  muxMode;
         uint8_t  pgaMode;
         uint16_t configValue;
+        uint16_t loThreshValue;
+        uint16_t hiThreshValue;
+        bool     configCached;
+        bool     loThreshCached;
+        bool     hiThreshCached;
+        bool     verifyOnRead;
+        bool     configDeferred;
+        bool     configDirty;
+        const ADS1115Calibration *calibration;
+        ADS1115CalCoeff calCoeff;       // for calKey
+        uint8_t  calKey;                // mux << 3 | pga, 0xFF if stale
+#ifdef ADS1115_STATS
+        ADS1115Stats stats;
+#endif
 };
 
 #endif /* _ADS1115_H_ */
@@ -0,0 +1,70 @@
+#include "ADS1115.h"
+#include "ADS1115AutoRange.h"
+
+/** Auto-ranging state for one input.
+ * @param mux MUX setting of the input
+ * @param minGain Widest range allowed (e.g. ADS1115_PGA_4P096 when the
+ *        input can never exceed VDD = 3.3 V)
+ * @param maxGain Narrowest range allowed
+ */
+ADS1115AutoRange::ADS1115AutoRange(uint8_t mux, uint8_t minGain,
+                                   uint8_t maxGain)
+{
+    this->mux = mux;
+    this->minGain = minGain > ADS1115_PGA_0P256 ? ADS1115_PGA_0P256 : minGain;
+    this->maxGain = maxGain > ADS1115_PGA_0P256 ? ADS1115_PGA_0P256 : maxGain;
+    if (this->maxGain < this->minGain) {
+        this->maxGain = this->minGain;
+    }
+    gain = this->minGain;   // start wide, range in from there
+}
+
+/** Force the PGA for the next conversion (clamped to the allowed span).
+ */
+void ADS1115AutoRange::setGain(uint8_t gain)
+{
+    this->gain = gain < minGain ? minGain : (gain > maxGain ? maxGain : gain);
+}
+
+/** Take the result of a conversion run at getGain() and choose the PGA for
+ * the next one.
+ * @param raw Conversion result
+ * @return The reading, scaled for the PGA it was taken at
+ */
+ADS1115RangedReading ADS1115AutoRange::update(int16_t raw)
+{
+    ADS1115RangedReading reading;
+    uint16_t magnitude = raw < 0 ? (uint16_t)(-(int32_t)raw) : (uint16_t)raw;
+    uint8_t next = gain;
+
+    reading.raw = raw;
+    reading.pga = gain;
+    reading.microVolts = ADS1115CFG::microVolts(raw, gain);
+    reading.flags = 0;
+    reading.status = ADS1115_STATUS_OK;
+
+    if (raw == 0x7FFF || raw == (int16_t)0x8000) {
+        reading.flags |= ADS1115_RANGE_SATURATED;
+        next = minGain;
+    } else if (magnitude > ADS1115_RANGE_DOWN_LIMIT) {
+        if (next > minGain) {
+            next--;
+        }
+    } else {
+        // |raw| * FS(gain) / FS(candidate) < UP_LIMIT, kept in integers
+        uint32_t level = (uint32_t)magnitude * ADS1115CFG::fullScale(gain);
+        while (next < maxGain &&
+               level < (uint32_t)ADS1115_RANGE_UP_LIMIT *
+                       ADS1115CFG::fullScale((uint8_t)(next + 1))) {
+            next++;
+        }
+    }
+
+    if (next != gain) {
+        reading.flags |= ADS1115_RANGE_CHANGED;
+        gain = next;
+    }
+    return reading;
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,57 @@
+#ifndef _ADS1115AUTORANGE_H_
+#define _ADS1115AUTORANGE_H_
+
+#include <inttypes.h>
+
+#define ADS1115_RANGE_SATURATED     0x01 // reading clipped at full scale
+#define ADS1115_RANGE_CHANGED       0x02 // next conversion uses another PGA
+
+// Step to a higher gain only if the reading lands below this fraction of
+// the new range, and step down once it passes the upper one. The gap
+// between them is the hysteresis.
+#define ADS1115_RANGE_UP_LIMIT      24576 // 75% of full scale
+#define ADS1115_RANGE_DOWN_LIMIT    31130 // 95% of full scale
+
+/** One auto-ranged reading.
+ * microVolts is already scaled for the PGA the conversion ran at.
+ */
+struct ADS1115RangedReading {
+    int32_t microVolts;
+    int16_t raw;
+    uint8_t pga;            // PGA the conversion ran at
+    uint8_t flags;
+    uint8_t status;         // ADS1115_STATUS_*
+};
+
+/** Per-channel PGA selection.
+ * After each conversion, update() picks the gain for the next one:
+ * - clipped at 0x7FFF/0x8000: jump to the widest allowed range, since the
+ *   real level is unknown;
+ * - above ADS1115_RANGE_DOWN_LIMIT: one range wider;
+ * - otherwise the highest gain at which the reading stays below
+ *   ADS1115_RANGE_UP_LIMIT of full scale.
+ * ADS1115::getAutoRanged() sends the chosen PGA with the next trigger, so
+ * ranging never costs an extra write or conversion.
+ */
+class ADS1115AutoRange {
+    public:
+        ADS1115AutoRange(uint8_t mux,
+                         uint8_t minGain = 0x00,    // ADS1115_PGA_6P144
+                         uint8_t maxGain = 0x05);   // ADS1115_PGA_0P256
+
+        uint8_t getMux() const { return mux; }
+        uint8_t getGain() const { return gain; }
+        void setGain(uint8_t gain);
+
+        ADS1115RangedReading update(int16_t raw);
+
+    private:
+        uint8_t mux;
+        uint8_t gain;           // PGA for the next conversion
+        uint8_t minGain;        // widest allowed range (lowest PGA code)
+        uint8_t maxGain;        // narrowest allowed range
+};
+
+#endif /* _ADS1115AUTORANGE_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,352 @@
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <string.h>
+#include <linux/i2c.h>
+
+#include "ADS1115.h"
+#include "ADS1115LinuxBus.h"
+#include "ADS1115Batch.h"
+
+ADS1115Batch::ADS1115Batch(ADS1115LinuxBus &bus)
+{
+    this->bus = &bus;
+    clear();
+}
+
+/** Drop everything queued.
+ */
+void ADS1115Batch::clear()
+{
+    msgCount = 0;
+    used = 0;
+}
+
+bool ADS1115Batch::reserve(uint8_t msgs, uint8_t bytes)
+{
+    return msgCount + msgs <= ADS1115_BATCH_MAX_MSGS &&
+           used + bytes <= ADS1115_BATCH_BUFFER_SIZE;
+}
+
+void ADS1115Batch::add(uint8_t addr, uint8_t read, uint8_t len,
+                       uint16_t *value, uint32_t *sent)
+{
+    Message &msg = msgs[msgCount++];
+    msg.addr = addr;
+    msg.read = read;
+    msg.len = len;
+    msg.offset = used;
+    msg.value = value;
+    msg.sent = sent;
+    used += len;
+}
+
+/** Queue a raw write; data is copied.
+ * @param sent If given, receives the bus time after a successful submit()
+ * @return False if the batch is full
+ */
+bool ADS1115Batch::write(uint8_t addr, const uint8_t *data, uint8_t len,
+                         uint32_t *sent)
+{
+    if (!reserve(1, len)) {
+        return false;
+    }
+    memcpy(buffer + used, data, len);
+    add(addr, 0, len, 0, sent);
+    return true;
+}
+
+/** Queue a 16-bit register write (pointer byte + value, MSB first).
+ * @param sent If given, receives the bus time after a successful submit()
+ * @return False if the batch is full
+ */
+bool ADS1115Batch::writeRegister(uint8_t addr, uint8_t regAddr,
+                                 uint16_t value, uint32_t *sent)
+{
+    uint8_t data[3];
+
+    data[0] = regAddr;
+    data[1] = (value & 0xFF00) >> 8;
+    data[2] = value & 0x00FF;
+    return write(addr, data, 3, sent);
+}
+
+/** Queue a pointer write and a 2-byte read of a 16-bit register.
+ * @param value Receives the register after a successful submit()
+ * @return False if the batch is full
+ */
+bool ADS1115Batch::readRegister(uint8_t addr, uint8_t regAddr,
+                                uint16_t *value)
+{
+    if (!reserve(2, 3)) {
+        return false;
+    }
+    buffer[used] = regAddr;
+    add(addr, 0, 1, 0, 0);
+    add(addr, 1, 2, value, 0);
+    return true;
+}
+
+/** Send the queued messages in one I2C_RDWR call, store register reads and
+ * send times, and empty the batch.
+ * @return ADS1115_BUS_OK, ADS1115_BUS_NACK_ADDR or ADS1115_BUS_ERROR
+ */
+uint8_t ADS1115Batch::submit()
+{
+    struct i2c_msg out[ADS1115_BATCH_MAX_MSGS];
+    uint8_t status;
+
+    if (msgCount == 0) {
+        return ADS1115_BUS_OK;
+    }
+    for (uint8_t i = 0; i < msgCount; i++) {
+        out[i].addr  = msgs[i].addr;
+        out[i].flags = msgs[i].read ? I2C_M_RD : 0;
+        out[i].len   = msgs[i].len;
+        out[i].buf   = buffer + msgs[i].offset;
+    }
+    status = bus->transfer(out, msgCount);
+    if (status == ADS1115_BUS_OK) {
+        uint32_t now = bus->micros();
+        for (uint8_t i = 0; i < msgCount; i++) {
+            if (msgs[i].value) {
+                const uint8_t *data = buffer + msgs[i].offset;
+                *msgs[i].value = (data[0] << 8) | data[1];
+            }
+            if (msgs[i].sent) {
+                *msgs[i].sent = now;
+            }
+        }
+    }
+    clear();
+    return status;
+}
+
+#if defined(ADS1115_BUS_LINUX)
+ADS1115BatchScan::ADS1115BatchScan(ADS1115LinuxBus &bus) : batch(bus)
+{
+    this->bus = &bus;
+    deviceCount = 0;
+}
+
+/** Add a device on the scan's bus and the channels to convert on it.
+ * @param adc Device; rate and comparator settings are taken as configured
+ * @param channels MUX/PGA list, kept by reference
+ * @param count Number of channels (1..ADS1115_BATCH_SCAN_MAX_CHANNELS)
+ * @return False if the scan is full or count is out of range
+ */
+bool ADS1115BatchScan::add(ADS1115 &adc, const ADS1115ScanChannel *channels,
+                           uint8_t count)
+{
+    if (deviceCount >= ADS1115_BATCH_SCAN_MAX_DEVICES || count == 0 ||
+        count > ADS1115_BATCH_SCAN_MAX_CHANNELS) {
+        return false;
+    }
+    Device &device = devices[deviceCount++];
+    device.adc = &adc;
+    device.channels = channels;
+    device.count = count;
+    device.valid = 0;
+    return true;
+}
+
+/** Total number of channels over all devices (the size scan() fills).
+ */
+uint8_t ADS1115BatchScan::getChannelCount() const
+{
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        total += devices[i].count;
+    }
+    return total;
+}
+
+/** Channels of one device that the last scan() converted. The out[]
+ * entries of the others still hold whatever was there before.
+ * @param device Device index, in add() order
+ * @return Bit n set if channel n of the device's list was converted
+ */
+uint8_t ADS1115BatchScan::getValidMask(uint8_t device) const
+{
+    return devices[device].valid;
+}
+
+/** Queue one device's part of a step.
+ * @return False if nothing was queued, e.g. a trigger for a device whose
+ *         CONFIG could not be read back
+ */
+bool ADS1115BatchScan::queue(Device &device, Step step)
+{
+    switch (step) {
+        case STEP_START:
+            return device.adc->queueTrigger(batch, device.channels[0]);
+        case STEP_STATUS:
+            device.adc->queueStatus(batch, &device.status);
+            break;
+        case STEP_READ:
+            device.adc->queueConversion(batch, &device.value);
+            if (device.next + 1 < device.count) {
+                device.adc->queueTrigger(batch,
+                                         device.channels[device.next + 1]);
+            }
+            break;
+    }
+    return true;
+}
+
+/** Run one step for a set of devices in one call. If the call fails, each
+ * device gets a call of its own, so one missing device cannot stall the
+ * others.
+ * @param mask Bit n = device n
+ * @return Devices whose step went through
+ */
+uint8_t ADS1115BatchScan::send(uint8_t mask, Step step)
+{
+    uint8_t done = 0;
+
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if ((mask & (1 << i)) && !queue(devices[i], step)) {
+            mask &= ~(1 << i);
+        }
+    }
+    if (!mask) {
+        return 0;
+    }
+    if (batch.submit() == ADS1115_BUS_OK) {
+        return mask;
+    }
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        if (mask != (1 << i)) {
+            done |= send(1 << i, step);
+        } else if (step != STEP_STATUS) {
+            // the queued trigger already moved the CONFIG shadow
+            devices[i].adc->invalidate();
+        }
+    }
+    return done;
+}
+
+void ADS1115BatchScan::started(Device &device)
+{
+    device.started = bus->micros();
+    device.pollAt = device.nominal;
+    device.backoff = device.nominal / 32;
+}
+
+/** Convert every device's channel list once, devices in parallel.
+ * @param out Raw results, device by device in add() order, each device's
+ *        channels in list order (getChannelCount() entries)
+ * @return Number of channels converted (fewer than getChannelCount() if
+ *         some conversions timed out or a device did not answer; see
+ *         getValidMask() for which)
+ */
+uint8_t ADS1115BatchScan::scan(int16_t *out)
+{
+    uint8_t active = 0;
+    uint8_t converted = 0;
+
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        Device &device = devices[i];
+        uint8_t rate = (device.adc->getConfig() & ADS1115_CFG_DR_MASK) >>
+                       ADS1115_CFG_DR_SHIFT;
+
+        device.nominal = ADS1115::getConversionTime(rate) + ADS1115_WAKEUP_US;
+        device.out = out;
+        device.next = 0;
+        device.valid = 0;
+        out += device.count;
+        active |= 1 << i;
+    }
+    if (!active) {
+        return 0;
+    }
+    active = send(active, STEP_START);
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (active & (1 << i)) {
+            started(devices[i]);
+        }
+    }
+
+    while (active) {
+        uint32_t now = bus->micros();
+        uint32_t wait = 0xFFFFFFFF;
+        uint8_t due = 0, ready = 0;
+
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            if (!(active & (1 << i))) {
+                continue;
+            }
+            uint32_t elapsed = now - devices[i].started;
+            if (elapsed >= devices[i].pollAt) {
+                due |= 1 << i;
+            } else if (devices[i].pollAt - elapsed < wait) {
+                wait = devices[i].pollAt - elapsed;
+            }
+        }
+        if (!due) {
+            bus->sleepMicros(wait);
+            continue;
+        }
+
+        // Status first: results and triggers only go to devices whose
+        // conversion is known to be over
+        uint8_t polled = send(due, STEP_STATUS);
+        active &= ~(due & ~polled);
+        now = bus->micros();
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            Device &device = devices[i];
+            if (!(polled & (1 << i))) {
+                continue;
+            }
+            if (device.status & ADS1115_CFG_OS_BIT) {
+                ready |= 1 << i;
+                continue;
+            }
+            uint32_t elapsed = now - device.started;
+            uint32_t limit = device.nominal +
+                             device.nominal * ADS1115_OSC_TOLERANCE_PCT / 100;
+            if (elapsed >= 2 * limit) {
+                active &= ~(1 << i);
+                continue;
+            }
+            device.pollAt = elapsed + device.backoff;
+            if (elapsed < limit && device.pollAt > limit) {
+                device.pollAt = limit;
+            }
+            if (device.backoff < device.nominal / 8) {
+                device.backoff *= 2;
+            }
+        }
+        if (!ready) {
+            continue;
+        }
+
+        uint8_t read = send(ready, STEP_READ);
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            Device &device = devices[i];
+            if (!(ready & (1 << i))) {
+                continue;
+            }
+            if (!(read & (1 << i))) {
+                active &= ~(1 << i);
+                continue;
+            }
+            device.out[device.next] = device.value;
+            device.valid |= 1 << device.next;
+            converted++;
+            if (++device.next < device.count) {
+                started(device);
+            } else {
+                active &= ~(1 << i);
+            }
+        }
+    }
+    return converted;
+}
+#endif
+
+#endif /* __linux__ && !ARDUINO */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
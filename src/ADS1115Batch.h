@@ -0,0 +1,123 @@
+#ifndef _ADS1115BATCH_H_
+#define _ADS1115BATCH_H_
+
+#include <inttypes.h>
+
+class ADS1115;
+class ADS1115LinuxBus;
+struct ADS1115ScanChannel;
+
+// I2C_RDWR_IOCTL_MAX_MSGS: the kernel refuses longer message lists
+#define ADS1115_BATCH_MAX_MSGS      42
+#define ADS1115_BATCH_BUFFER_SIZE   128
+#define ADS1115_BATCH_SCAN_MAX_DEVICES  4   // addresses on one bus
+#define ADS1115_BATCH_SCAN_MAX_CHANNELS 8
+
+/** Queue of I2C messages for one Linux bus, sent in a single I2C_RDWR.
+ * Messages may address different devices; the kernel joins them with
+ * repeated starts and ends with one stop, so a whole scan step (trigger A,
+ * read B, read C ...) costs one syscall. The device drivers queue their own
+ * operations with ADS1115::queueTrigger() and ADS1115::queueConversion().
+ * Read results land in the caller's variables only after a successful
+ * submit(); the kernel fails the whole batch if any message is NACKed.
+ * A batch cannot act on its own reads, so anything that depends on a
+ * result (reading a conversion only once OS is set) needs the next batch;
+ * ADS1115BatchScan does that for whole scans.
+ */
+class ADS1115Batch {
+    public:
+        ADS1115Batch(ADS1115LinuxBus &bus);
+
+        bool write(uint8_t addr, const uint8_t *data, uint8_t len,
+                   uint32_t *sent = 0);
+        bool writeRegister(uint8_t addr, uint8_t regAddr, uint16_t value,
+                           uint32_t *sent = 0);
+        bool readRegister(uint8_t addr, uint8_t regAddr, uint16_t *value);
+
+        uint8_t submit();
+        void clear();
+
+        uint8_t getMessageCount() const { return msgCount; }
+        bool isEmpty() const { return msgCount == 0; }
+
+    private:
+        struct Message {
+            uint8_t   addr;
+            uint8_t   read;
+            uint8_t   len;
+            uint8_t   offset;       // into buffer
+            uint16_t *value;        // register read destination, or 0
+            uint32_t *sent;         // bus time the batch went out, or 0
+        };
+
+        bool reserve(uint8_t msgs, uint8_t bytes);
+        void add(uint8_t addr, uint8_t read, uint8_t len, uint16_t *value,
+                 uint32_t *sent);
+
+        ADS1115LinuxBus *bus;
+        Message  msgs[ADS1115_BATCH_MAX_MSGS];
+        uint8_t  msgCount;
+        uint8_t  buffer[ADS1115_BATCH_BUFFER_SIZE];
+        uint8_t  used;
+};
+
+/** Channel lists of up to four devices on one Linux bus, converted side by
+ * side with two I2C_RDWR calls per step however many devices take part.
+ * The first call reads CONFIG from every device whose conversion is due;
+ * the second reads the result of each device whose OS bit came back set
+ * and triggers its next channel. A device that is not ready is polled
+ * again in a later status call, so neither its result nor its MUX is
+ * touched before OS says the conversion is over. A scan of N channels per
+ * device takes 1 + 2N ioctls when no device needs polling twice.
+ *
+ * As in ADS1115Coordinator, a conversion past the oscillator tolerance is
+ * polled on, up to twice that, and a device that still has not confirmed
+ * by then is left alone for the rest of the scan: it would ignore a new
+ * trigger and its next result would be taken for the wrong channel. When a
+ * call fails (one NACK fails the whole list), its devices are retried one
+ * call each and those that fail again drop out of the scan. Linux bus
+ * builds only.
+ */
+class ADS1115BatchScan {
+    public:
+        ADS1115BatchScan(ADS1115LinuxBus &bus);
+
+        bool add(ADS1115 &adc, const ADS1115ScanChannel *channels,
+                 uint8_t count);
+        uint8_t getDeviceCount() const { return deviceCount; }
+        uint8_t getChannelCount() const;
+
+        uint8_t scan(int16_t *out);
+        uint8_t getValidMask(uint8_t device) const;
+
+    private:
+        enum Step { STEP_START, STEP_STATUS, STEP_READ };
+
+        struct Device {
+            ADS1115 *adc;
+            const ADS1115ScanChannel *channels;
+            uint8_t  count;
+            uint8_t  next;          // channel whose result is pending
+            uint8_t  valid;         // bit n = channel n converted
+            uint16_t status;        // CONFIG from the last status call
+            int16_t  value;
+            uint32_t started;       // bus clock when the trigger went out
+            uint32_t nominal;       // conversion time + wake-up, us
+            uint32_t pollAt;        // next status call, us after started
+            uint32_t backoff;
+            int16_t *out;
+        };
+
+        bool queue(Device &device, Step step);
+        uint8_t send(uint8_t mask, Step step);
+        void started(Device &device);
+
+        ADS1115LinuxBus *bus;
+        ADS1115Batch batch;
+        Device  devices[ADS1115_BATCH_SCAN_MAX_DEVICES];
+        uint8_t deviceCount;
+};
+
+#endif /* _ADS1115BATCH_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,396 @@
+#if !defined(ARDUINO)
+
+#include <atomic>
+
+#include "ADS1115CFG.h"
+#include "ADS1115Bulk.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ADS1115_BULK_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ADS1115_BULK_NEON
+#include <arm_neon.h>
+#endif
+
+// Per-lane constants are laid out as a pattern of channels * LANES entries,
+// so every vector load starts at a multiple of the widest vector and the
+// pattern wraps without a remainder.
+#define ADS1115_BULK_LANES      8
+#define ADS1115_BULK_PATTERN    (ADS1115Bulk::MAX_CHANNELS * ADS1115_BULK_LANES)
+
+// setKernel() choice; KERNEL_AUTO until one is forced. Any thread may
+// convert while another calls setKernel().
+static std::atomic<ADS1115Bulk::Kernel> activeKernel(ADS1115Bulk::KERNEL_AUTO);
+
+// uV * 16 per count: (raw * m16 + 8) >> 4 rounds exactly like
+// ADS1115CFG::microVolts(), but with one shift for every PGA code.
+static int32_t microVolts16(uint8_t pga)
+{
+    return (int32_t)ADS1115CFG::Tables::uvMul[pga & 0x07] <<
+           (4 - ADS1115CFG::Tables::uvShift[pga & 0x07]);
+}
+
+// -----------------------------------------------------------------------------
+// Scalar kernels
+// -----------------------------------------------------------------------------
+
+static void microScalar(const int16_t *raw, int32_t *out, size_t count,
+                        const int32_t *mul, size_t period, size_t phase)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = ((int32_t)raw[i] * mul[phase] + 8) >> 4;
+        if (++phase == period) {
+            phase = 0;
+        }
+    }
+}
+
+static void affineScalar(const int16_t *raw, float *out, size_t count,
+                         const float *scale, const float *offset,
+                         size_t period, size_t phase)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (float)raw[i] * scale[phase] + offset[phase];
+        if (++phase == period) {
+            phase = 0;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// x86 kernels (compiled for their ISA, selected at run time)
+// -----------------------------------------------------------------------------
+
+#if defined(ADS1115_BULK_X86)
+
+__attribute__((target("sse4.1")))
+static size_t microSSE41(const int16_t *raw, int32_t *out, size_t count,
+                         const int32_t *mul, size_t period)
+{
+    const __m128i round = _mm_set1_epi32(8);
+    size_t i = 0, phase = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i r = _mm_cvtepi16_epi32(
+            _mm_loadl_epi64((const __m128i *)(raw + i)));
+        __m128i m = _mm_loadu_si128((const __m128i *)(mul + phase));
+        r = _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(r, m), round), 4);
+        _mm_storeu_si128((__m128i *)(out + i), r);
+        phase += 4;
+        if (phase == period) {
+            phase = 0;
+        }
+    }
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+static size_t affineSSE41(const int16_t *raw, float *out, size_t count,
+                          const float *scale, const float *offset,
+                          size_t period)
+{
+    size_t i = 0, phase = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 r = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(
+            _mm_loadl_epi64((const __m128i *)(raw + i))));
+        __m128 s = _mm_loadu_ps(scale + phase);
+        __m128 o = _mm_loadu_ps(offset + phase);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(r, s), o));
+        phase += 4;
+        if (phase == period) {
+            phase = 0;
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t microAVX2(const int16_t *raw, int32_t *out, size_t count,
+                        const int32_t *mul, size_t period)
+{
+    const __m256i round = _mm256_set1_epi32(8);
+    size_t i = 0, phase = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i r = _mm256_cvtepi16_epi32(
+            _mm_loadu_si128((const __m128i *)(raw + i)));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mul + phase));
+        r = _mm256_srai_epi32(
+            _mm256_add_epi32(_mm256_mullo_epi32(r, m), round), 4);
+        _mm256_storeu_si256((__m256i *)(out + i), r);
+        phase += 8;
+        if (phase == period) {
+            phase = 0;
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t affineAVX2(const int16_t *raw, float *out, size_t count,
+                         const float *scale, const float *offset,
+                         size_t period)
+{
+    size_t i = 0, phase = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 r = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+            _mm_loadu_si128((const __m128i *)(raw + i))));
+        __m256 s = _mm256_loadu_ps(scale + phase);
+        __m256 o = _mm256_loadu_ps(offset + phase);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(r, s), o));
+        phase += 8;
+        if (phase == period) {
+            phase = 0;
+        }
+    }
+    return i;
+}
+
+#endif /* ADS1115_BULK_X86 */
+
+// -----------------------------------------------------------------------------
+// NEON kernels (selected at build time)
+// -----------------------------------------------------------------------------
+
+#if defined(ADS1115_BULK_NEON)
+
+static size_t microNEON(const int16_t *raw, int32_t *out, size_t count,
+                        const int32_t *mul, size_t period)
+{
+    size_t i = 0, phase = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t r = vmovl_s16(vld1_s16(raw + i));
+        r = vrshrq_n_s32(vmulq_s32(r, vld1q_s32(mul + phase)), 4);
+        vst1q_s32(out + i, r);
+        phase += 4;
+        if (phase == period) {
+            phase = 0;
+        }
+    }
+    return i;
+}
+
+static size_t affineNEON(const int16_t *raw, float *out, size_t count,
+                         const float *scale, const float *offset,
+                         size_t period)
+{
+    size_t i = 0, phase = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t r = vcvtq_f32_s32(vmovl_s16(vld1_s16(raw + i)));
+        r = vmlaq_f32(vld1q_f32(offset + phase), r, vld1q_f32(scale + phase));
+        vst1q_f32(out + i, r);
+        phase += 4;
+        if (phase == period) {
+            phase = 0;
+        }
+    }
+    return i;
+}
+
+#endif /* ADS1115_BULK_NEON */
+
+// -----------------------------------------------------------------------------
+// Dispatch
+// -----------------------------------------------------------------------------
+
+static bool kernelSupported(ADS1115Bulk::Kernel kernel)
+{
+    switch (kernel) {
+        case ADS1115Bulk::KERNEL_SCALAR:
+            return true;
+#if defined(ADS1115_BULK_X86)
+        case ADS1115Bulk::KERNEL_SSE41:
+            return __builtin_cpu_supports("sse4.1");
+        case ADS1115Bulk::KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#if defined(ADS1115_BULK_NEON)
+        case ADS1115Bulk::KERNEL_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+// Widest kernel this CPU runs, probed once (the static is initialised
+// thread-safely on first use)
+static ADS1115Bulk::Kernel bestKernel()
+{
+    static const ADS1115Bulk::Kernel best =
+        kernelSupported(ADS1115Bulk::KERNEL_AVX2)  ? ADS1115Bulk::KERNEL_AVX2 :
+        kernelSupported(ADS1115Bulk::KERNEL_SSE41) ? ADS1115Bulk::KERNEL_SSE41 :
+        kernelSupported(ADS1115Bulk::KERNEL_NEON)  ? ADS1115Bulk::KERNEL_NEON :
+                                                     ADS1115Bulk::KERNEL_SCALAR;
+    return best;
+}
+
+static ADS1115Bulk::Kernel resolveKernel()
+{
+    ADS1115Bulk::Kernel kernel = activeKernel.load(std::memory_order_relaxed);
+
+    return kernel == ADS1115Bulk::KERNEL_AUTO ? bestKernel() : kernel;
+}
+
+/** Force a kernel, e.g. to benchmark it against the scalar path.
+ * @param kernel Kernel to use, or KERNEL_AUTO to pick the widest available
+ * @return False if this CPU or build cannot run the kernel
+ */
+bool ADS1115Bulk::setKernel(Kernel kernel)
+{
+    if (kernel != KERNEL_AUTO && !kernelSupported(kernel)) {
+        return false;
+    }
+    activeKernel.store(kernel, std::memory_order_relaxed);
+    return true;
+}
+
+/** Get the kernel in use; KERNEL_AUTO resolves to the widest this CPU runs.
+ */
+ADS1115Bulk::Kernel ADS1115Bulk::getKernel()
+{
+    return resolveKernel();
+}
+
+const char *ADS1115Bulk::getKernelName(Kernel kernel)
+{
+    switch (kernel) {
+        case KERNEL_SCALAR: return "scalar";
+        case KERNEL_SSE41:  return "sse4.1";
+        case KERNEL_AVX2:   return "avx2";
+        case KERNEL_NEON:   return "neon";
+        default:            return "auto";
+    }
+}
+
+static size_t runMicro(const int16_t *raw, int32_t *out, size_t count,
+                       const int32_t *mul, size_t period)
+{
+    switch (resolveKernel()) {
+#if defined(ADS1115_BULK_X86)
+        case ADS1115Bulk::KERNEL_AVX2:
+            return microAVX2(raw, out, count, mul, period);
+        case ADS1115Bulk::KERNEL_SSE41:
+            return microSSE41(raw, out, count, mul, period);
+#endif
+#if defined(ADS1115_BULK_NEON)
+        case ADS1115Bulk::KERNEL_NEON:
+            return microNEON(raw, out, count, mul, period);
+#endif
+        default:
+            return 0;
+    }
+}
+
+static size_t runAffine(const int16_t *raw, float *out, size_t count,
+                        const float *scale, const float *offset,
+                        size_t period)
+{
+    switch (resolveKernel()) {
+#if defined(ADS1115_BULK_X86)
+        case ADS1115Bulk::KERNEL_AVX2:
+            return affineAVX2(raw, out, count, scale, offset, period);
+        case ADS1115Bulk::KERNEL_SSE41:
+            return affineSSE41(raw, out, count, scale, offset, period);
+#endif
+#if defined(ADS1115_BULK_NEON)
+        case ADS1115Bulk::KERNEL_NEON:
+            return affineNEON(raw, out, count, scale, offset, period);
+#endif
+        default:
+            return 0;
+    }
+}
+
+/** Convert interleaved raw counts to microvolts.
+ * Output is bit-identical to ADS1115CFG::microVolts() on every kernel.
+ * @param raw Raw conversion results, frame-interleaved
+ * @param out Destination, count entries
+ * @param count Total number of samples (all channels)
+ * @param channels Samples per frame, 1..MAX_CHANNELS
+ * @param pga PGA code of each channel
+ */
+void ADS1115Bulk::toMicroVolts(const int16_t *raw, int32_t *out, size_t count,
+                               uint8_t channels, const uint8_t *pga)
+{
+    int32_t mul[ADS1115_BULK_PATTERN];
+    size_t period = (size_t)channels * ADS1115_BULK_LANES;
+    size_t done;
+
+    if (channels == 0 || channels > MAX_CHANNELS) {
+        return;
+    }
+    for (size_t i = 0; i < period; i++) {
+        mul[i] = microVolts16(pga[i % channels]);
+    }
+    done = runMicro(raw, out, count, mul, period);
+    microScalar(raw + done, out + done, count - done, mul, period,
+                done % period);
+}
+
+/** Convert interleaved raw counts to millivolts.
+ * @param raw Raw conversion results, frame-interleaved
+ * @param out Destination, count entries
+ * @param count Total number of samples (all channels)
+ * @param channels Samples per frame, 1..MAX_CHANNELS
+ * @param pga PGA code of each channel
+ */
+void ADS1115Bulk::toMilliVolts(const int16_t *raw, float *out, size_t count,
+                               uint8_t channels, const uint8_t *pga)
+{
+    float scale[ADS1115_BULK_PATTERN];
+    float offset[ADS1115_BULK_PATTERN];
+    size_t period = (size_t)channels * ADS1115_BULK_LANES;
+    size_t done;
+
+    if (channels == 0 || channels > MAX_CHANNELS) {
+        return;
+    }
+    for (size_t i = 0; i < period; i++) {
+        scale[i] = ADS1115CFG::mvPerCount(pga[i % channels]);
+        offset[i] = 0.0f;
+    }
+    done = runAffine(raw, out, count, scale, offset, period);
+    affineScalar(raw + done, out + done, count - done, scale, offset, period,
+                 done % period);
+}
+
+/** Convert interleaved raw counts to calibrated units: raw * scale + offset.
+ * @param raw Raw conversion results, frame-interleaved
+ * @param out Destination, count entries
+ * @param count Total number of samples (all channels)
+ * @param channels Samples per frame, 1..MAX_CHANNELS
+ * @param scale Units per count of each channel
+ * @param offset Units at zero counts of each channel
+ */
+void ADS1115Bulk::toUnits(const int16_t *raw, float *out, size_t count,
+                          uint8_t channels, const float *scale,
+                          const float *offset)
+{
+    float s[ADS1115_BULK_PATTERN];
+    float o[ADS1115_BULK_PATTERN];
+    size_t period = (size_t)channels * ADS1115_BULK_LANES;
+    size_t done;
+
+    if (channels == 0 || channels > MAX_CHANNELS) {
+        return;
+    }
+    for (size_t i = 0; i < period; i++) {
+        s[i] = scale[i % channels];
+        o[i] = offset[i % channels];
+    }
+    done = runAffine(raw, out, count, s, o, period);
+    affineScalar(raw + done, out + done, count - done, s, o, period,
+                 done % period);
+}
+
+#endif /* !ARDUINO */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,42 @@
+#ifndef _ADS1115BULK_H_
+#define _ADS1115BULK_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+
+/** Host-side batch conversion of raw ADS1115 counts.
+ * Buffers are frame-interleaved: sample i belongs to channel (i % channels),
+ * and every channel carries its own PGA code (or scale/offset). Kernels for
+ * SSE4.1, AVX2 and NEON are picked at run time (x86) or build time (ARM),
+ * with a portable scalar fallback that produces bit-identical int32 output.
+ */
+class ADS1115Bulk {
+    public:
+        enum Kernel {
+            KERNEL_AUTO = 0,
+            KERNEL_SCALAR,
+            KERNEL_SSE41,
+            KERNEL_AVX2,
+            KERNEL_NEON
+        };
+
+        static const uint8_t MAX_CHANNELS = 64;
+
+        static bool setKernel(Kernel kernel);
+        static Kernel getKernel();
+        static const char *getKernelName(Kernel kernel);
+
+        static void toMicroVolts(const int16_t *raw, int32_t *out,
+                                 size_t count, uint8_t channels,
+                                 const uint8_t *pga);
+        static void toMilliVolts(const int16_t *raw, float *out,
+                                 size_t count, uint8_t channels,
+                                 const uint8_t *pga);
+        static void toUnits(const int16_t *raw, float *out,
+                            size_t count, uint8_t channels,
+                            const float *scale, const float *offset);
+};
+
+#endif /* _ADS1115BULK_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,65 @@
+#ifndef _ADS1115BUS_H_
+#define _ADS1115BUS_H_
+
+// -----------------------------------------------------------------------------
+// I2C transport selection. The driver talks to the bus through a concrete
+// (non-virtual) class chosen at compile time, so the Arduino build inlines
+// straight down to Wire calls. Pass one of these as a compiler flag to
+// override the default (Wire on Arduino, /dev/i2c-N on Linux, and the
+// simulator on other hosts, which have no I2C transport here).
+// -----------------------------------------------------------------------------
+//#define ADS1115_BUS_WIRE      // Arduino TwoWire
+//#define ADS1115_BUS_LINUX     // Linux i2c-dev, I2C_RDWR ioctls
+//#define ADS1115_BUS_SIM       // in-memory simulated devices
+
+#if !defined(ADS1115_BUS_WIRE) && !defined(ADS1115_BUS_LINUX) && \
+    !defined(ADS1115_BUS_SIM)
+#if defined(ARDUINO)
+#define ADS1115_BUS_WIRE
+#elif defined(__linux__)
+#define ADS1115_BUS_LINUX
+#else
+#define ADS1115_BUS_SIM
+#endif
+#endif
+
+#if defined(ADS1115_BUS_LINUX) && !defined(__linux__)
+#error "ADS1115_BUS_LINUX needs Linux i2c-dev; use ADS1115_BUS_SIM"
+#endif
+
+/* Every transport provides the same small set of inline-able methods:
+ *
+ *   void    begin();
+ *   uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len);
+ *   uint8_t read(uint8_t addr, uint8_t *data, uint8_t len);
+ *   uint8_t writeRead(uint8_t addr, const uint8_t *wdata, uint8_t wlen,
+ *                     uint8_t *rdata, uint8_t rlen);
+ *   uint32_t micros();
+ *   void    sleepMicros(uint32_t us);
+ *
+ * write() returns 0 on success or a Wire-style error code (2 = address NACK,
+ * 3 = data NACK, 4 = other), read() returns the number of bytes received.
+ * writeRead() issues the write and the read as one transaction joined by a
+ * repeated start and returns the number of bytes read (0 on any failure).
+ * micros() is a free-running microsecond clock (compare with wrap-safe
+ * subtraction) and sleepMicros() waits, yielding where the platform can.
+ */
+#define ADS1115_BUS_OK              0
+#define ADS1115_BUS_NACK_ADDR       2
+#define ADS1115_BUS_NACK_DATA       3
+#define ADS1115_BUS_ERROR           4
+
+#if defined(ADS1115_BUS_WIRE)
+#include "ADS1115WireBus.h"
+typedef ADS1115WireBus ADS1115Bus;
+#elif defined(ADS1115_BUS_LINUX)
+#include "ADS1115LinuxBus.h"
+typedef ADS1115LinuxBus ADS1115Bus;
+#elif defined(ADS1115_BUS_SIM)
+#include "ADS1115SimBus.h"
+typedef ADS1115SimBus ADS1115Bus;
+#endif
+
+#endif /* _ADS1115BUS_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
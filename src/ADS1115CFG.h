@@ -1,117 +1,283 @@
 #ifndef _ADS1115CFG_H_
 #define _ADS1115CFG_H_
 
-typedef enum
+#include <inttypes.h>
+
+// -----------------------------------------------------------------------------
+// Strongly typed CONFIG fields and compile-time configuration words.
+// Everything here is constexpr: Config<...>::value folds to a uint16_t literal
+// and the per-PGA tables are plain array lookups.
+// -----------------------------------------------------------------------------
+
+namespace ADS1115CFG {
+
+enum class Address : uint8_t {
+    GND = 0x48,             // address pin low (GND)
+    VDD = 0x49,             // address pin high (VCC)
+    SDA = 0x4A,             // address pin tied to SDA pin
+    SCL = 0x4B              // address pin tied to SCL pin
+};
+
+enum class Register : uint8_t {
+    CONVERSION = 0x00,
+    CONFIG     = 0x01,
+    LO_THRESH  = 0x02,
+    HI_THRESH  = 0x03
+};
+
+enum class Mux : uint8_t {
+    P0_N1  = 0x00,          // default
+    P0_N3  = 0x01,
+    P1_N3  = 0x02,
+    P2_N3  = 0x03,
+    P0_GND = 0x04,
+    P1_GND = 0x05,
+    P2_GND = 0x06,
+    P3_GND = 0x07
+};
+
+// Codes 0x06/0x07 alias 0x05 on the device and are deliberately left out.
+enum class Pga : uint8_t {
+    FSR_6V144 = 0x00,
+    FSR_4V096 = 0x01,
+    FSR_2V048 = 0x02,       // default
+    FSR_1V024 = 0x03,
+    FSR_0V512 = 0x04,
+    FSR_0V256 = 0x05
+};
+
+enum class Mode : uint8_t {
+    CONTINUOUS = 0x00,
+    SINGLESHOT = 0x01       // default
+};
+
+enum class Rate : uint8_t {
+    SPS_8   = 0x00,
+    SPS_16  = 0x01,
+    SPS_32  = 0x02,
+    SPS_64  = 0x03,
+    SPS_128 = 0x04,         // default
+    SPS_250 = 0x05,
+    SPS_475 = 0x06,
+    SPS_860 = 0x07
+};
+
+enum class CompMode : uint8_t {
+    HYSTERESIS = 0x00,      // default
+    WINDOW     = 0x01
+};
+
+enum class CompPol : uint8_t {
+    ACTIVE_LOW  = 0x00,     // default
+    ACTIVE_HIGH = 0x01
+};
+
+enum class CompLat : uint8_t {
+    NON_LATCHING = 0x00,    // default
+    LATCHING     = 0x01
+};
+
+enum class CompQue : uint8_t {
+    ASSERT_1 = 0x00,
+    ASSERT_2 = 0x01,
+    ASSERT_4 = 0x02,
+    DISABLED = 0x03         // default
+};
+
+// Lookup tables, indexed by raw field code (0..7). Namespace-scope
+// constexpr arrays would have internal linkage, giving every translation
+// unit that indexes them at run time its own copy (in SRAM on AVR); as
+// static members of a class template they are defined once per program.
+template <typename Unused = void>
+struct TableData {
+    // Full-scale range in mV, by PGA code
+    static constexpr uint16_t fullScale[8] = {
+        6144, 4096, 2048, 1024, 512, 256, 256, 256
+    };
+
+    // mV per count (FSR / 32768), by PGA code
+    static constexpr float mvPerCount[8] = {
+        0.1875f, 0.125f, 0.0625f, 0.03125f, 0.015625f,
+        0.0078125f, 0.0078125f, 0.0078125f
+    };
+
+    // uV per count as (uvMul >> uvShift), by PGA code:
+    // 187.5 = 375/2, 125 = 125/1, 62.5 = 125/2 ... 7.8125 = 125/16
+    static constexpr uint16_t uvMul[8] = {
+        375, 125, 125, 125, 125, 125, 125, 125
+    };
+    static constexpr uint8_t uvShift[8] = {
+        1, 0, 1, 2, 3, 4, 4, 4
+    };
+
+    // Nominal data rate in samples per second, by DR code
+    static constexpr uint16_t dataRate[8] = {
+        8, 16, 32, 64, 128, 250, 475, 860
+    };
+
+    // Nominal conversion time in us (1 / data rate), by DR code
+    static constexpr uint32_t conversionTime[8] = {
+        125000, 62500, 31250, 15625, 7813, 4000, 2106, 1163
+    };
+};
+
+template <typename Unused>
+constexpr uint16_t TableData<Unused>::fullScale[8];
+template <typename Unused>
+constexpr float TableData<Unused>::mvPerCount[8];
+template <typename Unused>
+constexpr uint16_t TableData<Unused>::uvMul[8];
+template <typename Unused>
+constexpr uint8_t TableData<Unused>::uvShift[8];
+template <typename Unused>
+constexpr uint16_t TableData<Unused>::dataRate[8];
+template <typename Unused>
+constexpr uint32_t TableData<Unused>::conversionTime[8];
+
+typedef TableData<> Tables;
+
+constexpr uint16_t dataRate(uint8_t rate)
 {
-ADDR_GND    =	0x48, // address pin low (GND)
-ADDR_VDD    =	0x49, // address pin high (VCC)
-ADDR_SDA    =	0x4A, // address pin tied to SDA pin
-ADDR_SCL	=	0x4B // address pin tied to SCL pin
-}ADS1115_ADDRESS
+    return Tables::dataRate[rate & 0x07];
+}
 
-typedef enum
+constexpr uint32_t conversionTime(uint8_t rate)
 {
-RA_CONVERSION	=	0x00,
-RA_CONFIG	=	0x01,
-RA_LO_THRESH	=	0x02,
-RA_HI_THRESH	=	0x03
-}ADS1115_RA
+    return Tables::conversionTime[rate & 0x07];
+}
 
-typedef enum
+constexpr uint32_t conversionTime(Rate rate)
 {
-CFG_OS_BIT	=	_BV(15),
-CFG_MUX_MASK	=	(_BV(14) | _BV(13) | _BV(12)),
-CFG_MUX_SHIFT	=	12,
-CFG_PGA_MASK	=	(_BV(11) | _BV(10) | _BV(9)),
-CFG_PGA_SHIFT	=	9,
-CFG_MODE_BIT	=	_BV(8),
-CFG_DR_MASK	=	(_BV(7) | _BV(6) | _BV(5)),
-CFG_DR_SHIFT	=	5,
-CFG_COMP_MODE_BIT	=	_BV(4),
-CFG_COMP_POL_BIT	=	_BV(3),
-CFG_COMP_LAT_BIT	=	_BV(2),
-CFG_COMP_QUE_MASK	=	(_BV(1) | _BV(0)),
-CFG_COMP_QUE_SHIFT	=	0
-}ADS1115_CFG
-
-typedef enum
+    return Tables::conversionTime[(uint8_t)rate];
+}
+
+constexpr uint16_t fullScale(uint8_t pga)
+{
+    return Tables::fullScale[pga & 0x07];
+}
+
+constexpr uint16_t fullScale(Pga pga)
+{
+    return Tables::fullScale[(uint8_t)pga];
+}
+
+constexpr float mvPerCount(uint8_t pga)
 {
-ADS1115_MUX_P0_N1	=	0x00, // default
-MUX_P0_N3	=	0x01,
-MUX_P1_N3	=	0x02,
-MUX_P2_N3	=	0x03,
-MUX_P0_NG	=	0x04,
-MUX_P1_NG	=	0x05,
-MUX_P2_NG	=	0x06,
-MUX_P3_NG	=	0x07
-}ADS1115_MUX
-
-typedef enum
+    return Tables::mvPerCount[pga & 0x07];
+}
+
+constexpr float mvPerCount(Pga pga)
+{
+    return Tables::mvPerCount[(uint8_t)pga];
+}
+
+/** Exact integer conversion of a raw count to microvolts, rounded to
+ * nearest. One 16x16->32 multiply and one shift; no floating point.
+ */
+constexpr int32_t microVolts(int16_t raw, uint8_t pga)
+{
+    return ((int32_t)raw * Tables::uvMul[pga & 0x07] +
+            ((1 << Tables::uvShift[pga & 0x07]) >> 1)) >>
+           Tables::uvShift[pga & 0x07];
+}
+
+constexpr int32_t microVolts(int16_t raw, Pga pga)
 {
-PGA_6P144	=	0x00,
-PGA_4P096	=	0x01,
-PGA_2P048	=	0x02, // default
-PGA_1P024	=	0x03,
-PGA_0P512	=	0x04,
-PGA_0P256	=	0x05,
-PGA_0P256B	=	0x06,
-PGA_0P256C	=	0x07
-}ADS1115_PGA
-
-typedef enum
+    return microVolts(raw, (uint8_t)pga);
+}
+
+constexpr int16_t clampCounts(int32_t counts)
 {
-MV_6P144	=	0.187500,
-MV_4P096	=	0.125000,
-MV_2P048	=	0.062500, // default
-MV_1P024	=	0.031250,
-MV_0P512	=	0.015625,
-MV_0P256	=	0.007813,
-MV_0P256B	=	0.007813,
-MV_0P256C	=	0.007813
-}ADS1115_MV
-
-typedef enum
+    return counts > 32767 ? 32767 :
+           counts < -32768 ? -32768 : (int16_t)counts;
+}
+
+constexpr int32_t clampMicroVolts(int32_t uv)
 {
-FSR_6P144	=	6144,
-FSR_4P096	=	4096,
-FSR_2P048	=	2048,
-FSR_1P024	=	1024,
-FSR_0P512	=	512,
-FSR_0P256	=	256
-}ADS1115_FSR
-
-typedef enum
+    return uv > 8000000 ? 8000000 : uv < -8000000 ? -8000000 : uv;
+}
+
+/** Inverse of microVolts(): the raw count closest to a voltage, clipped to
+ * the int16_t range like the converter itself. Used for thresholds.
+ */
+constexpr int16_t counts(int32_t uv, uint8_t pga)
 {
-CONTINUOUS	=	0x00,
-SINGLESHOT	=	0x01 // default
-}ADS1115_MODE
+    // The rounding term is signed 32-bit: with 16-bit int (AVR),
+    // uvMul / 2 is unsigned and -1 * it would wrap to a large positive
+    return clampCounts((clampMicroVolts(uv) *
+                        (1L << Tables::uvShift[pga & 0x07]) +
+                        (uv < 0 ? -1L : 1L) *
+                        (int32_t)(Tables::uvMul[pga & 0x07] / 2)) /
+                       (int32_t)Tables::uvMul[pga & 0x07]);
+}
 
-typedef enum
+constexpr int16_t counts(int32_t uv, Pga pga)
 {
-RATE_8	=	0x00,
-RATE_16	=	0x01,
-RATE_32	=	0x02,
-RATE_64	=	0x03,
-RATE_128	=	0x04, // default
-RATE_250	=	0x05,
-RATE_475	=	0x06,
-RATE_860	=	0x07
-}ADS1115_RATE
-
-typedef enum
+    return counts(uv, (uint8_t)pga);
+}
+
+static_assert(counts(-1000, 0x02) == -16 && counts(-1000000, 0x01) == -8000,
+              "counts() must round negative voltages in signed 32-bit");
+
+/** Compose a CONFIG register value (OS bit clear) from typed fields.
+ */
+constexpr uint16_t configWord(Mux mux, Pga pga, Rate rate,
+                              Mode mode = Mode::SINGLESHOT,
+                              CompMode compMode = CompMode::HYSTERESIS,
+                              CompPol compPol = CompPol::ACTIVE_LOW,
+                              CompLat compLat = CompLat::NON_LATCHING,
+                              CompQue compQue = CompQue::DISABLED)
 {
-COMP_MODE_HYSTERESIS	=	0x00, // default
-COMP_MODE_WINDOW	=	0x01,
+    return (uint16_t)(((uint16_t)mux  << 12) |
+                      ((uint16_t)pga  << 9)  |
+                      ((uint16_t)mode << 8)  |
+                      ((uint16_t)rate << 5)  |
+                      ((uint16_t)compMode << 4) |
+                      ((uint16_t)compPol  << 3) |
+                      ((uint16_t)compLat  << 2) |
+                      (uint16_t)compQue);
+}
+
+/** Compile-time CONFIG word.
+ * Config<Mux::P2_GND, Pga::FSR_4V096, Rate::SPS_860>::value is a constant;
+ * ::trigger additionally has the OS bit set to start a single-shot
+ * conversion. Comparator settings that would have no effect because
+ * COMP_QUE disables the comparator fail to compile, as they are almost
+ * certainly a mistake.
+ */
+template <Mux M,
+          Pga P = Pga::FSR_2V048,
+          Rate R = Rate::SPS_128,
+          Mode MD = Mode::SINGLESHOT,
+          CompMode CM = CompMode::HYSTERESIS,
+          CompPol CP = CompPol::ACTIVE_LOW,
+          CompLat CL = CompLat::NON_LATCHING,
+          CompQue CQ = CompQue::DISABLED>
+struct Config {
+    static_assert(!(CQ == CompQue::DISABLED && CL == CompLat::LATCHING),
+                  "COMP_LAT has no effect while COMP_QUE is disabled");
+    static_assert(!(CQ == CompQue::DISABLED && CM == CompMode::WINDOW),
+                  "COMP_MODE has no effect while COMP_QUE is disabled");
+
+    static constexpr uint16_t value = configWord(M, P, R, MD, CM, CP, CL, CQ);
+    static constexpr uint16_t trigger = value | 0x8000;
+    static constexpr uint16_t fullScaleMv = Tables::fullScale[(uint8_t)P];
+};
+
+template <Mux M, Pga P, Rate R, Mode MD, CompMode CM, CompPol CP, CompLat CL,
+          CompQue CQ>
+constexpr uint16_t Config<M, P, R, MD, CM, CP, CL, CQ>::value;
+
+template <Mux M, Pga P, Rate R, Mode MD, CompMode CM, CompPol CP, CompLat CL,
+          CompQue CQ>
+constexpr uint16_t Config<M, P, R, MD, CM, CP, CL, CQ>::trigger;
+
+template <Mux M, Pga P, Rate R, Mode MD, CompMode CM, CompPol CP, CompLat CL,
+          CompQue CQ>
+constexpr uint16_t Config<M, P, R, MD, CM, CP, CL, CQ>::fullScaleMv;
 
-COMP_POL_ACTIVE_LOW	=	0x00, // default
-COMP_POL_ACTIVE_HIGH	=	0x01,
+} // namespace ADS1115CFG
 
-COMP_LAT_NON_LATCHING	=	0x00, // default
-COMP_LAT_LATCHING	=	0x01,
+#endif /* _ADS1115CFG_H_ */
 
-COMP_QUE_ASSERT1	=	0x00,
-COMP_QUE_ASSERT2	=	0x01,
-COMP_QUE_ASSERT4	=	0x02,
-COMP_QUE_DISABLE	=	0x03 // default
-}ADS1115_COMP
-#endif
\ No newline at end of file
+// vim:ts=4:sw=4:ai:et:si:sts=4
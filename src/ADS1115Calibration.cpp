@@ -0,0 +1,343 @@
+#include "ADS1115.h"
+#include "ADS1115Calibration.h"
+#include "ADS1115Crc.h"
+
+#if !defined(ARDUINO)
+#include <stdio.h>
+#endif
+
+// Largest fused multiplier: 2^15 counts * 49152 keeps raw * mul inside 32
+// bits while leaving 15+ bits of multiplier precision. The offset folded
+// into add uses up the rest, so set() checks the sum (fits()).
+#define ADS1115_CAL_MUL_LIMIT       49152L
+
+// Accepted gain corrections, 0.5 .. 2.0
+#define ADS1115_CAL_GAIN_MIN        (ADS1115_CAL_GAIN_ONE / 2)
+#define ADS1115_CAL_GAIN_MAX        (ADS1115_CAL_GAIN_ONE * 2)
+
+static const uint8_t calMagic[4] = { 'A', 'D', 'S', 'C' };
+
+static void putLE32(uint8_t *p, int32_t value)
+{
+    uint32_t v = (uint32_t)value;
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static int32_t getLE32(const uint8_t *p)
+{
+    return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                     ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+ADS1115Calibration::ADS1115Calibration()
+{
+    clear();
+}
+
+void ADS1115Calibration::clear()
+{
+    count = 0;
+}
+
+/** Uncorrected transform for a PGA code; bit-identical to
+ * ADS1115CFG::microVolts().
+ */
+ADS1115CalCoeff ADS1115Calibration::nominal(uint8_t pga)
+{
+    ADS1115CalCoeff coeff;
+    uint8_t shift = ADS1115CFG::Tables::uvShift[pga & 0x07];
+
+    coeff.mul = ADS1115CFG::Tables::uvMul[pga & 0x07];
+    coeff.add = (1L << shift) >> 1;
+    coeff.shift = shift;
+    return coeff;
+}
+
+ADS1115Calibration::Entry *ADS1115Calibration::lookup(uint8_t key)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].key == key) {
+            return &entries[i];
+        }
+    }
+    return 0;
+}
+
+/** Fused coefficients of a calibrated pair.
+ * @return 0 if (mux, pga) has no entry
+ */
+const ADS1115CalCoeff *ADS1115Calibration::find(uint8_t mux,
+                                                uint8_t pga) const
+{
+    uint8_t key = ((mux & 0x07) << 3) | (pga & 0x07);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].key == key) {
+            return &entries[i].coeff;
+        }
+    }
+    return 0;
+}
+
+/** Whether raw * mul + add stays inside int32_t for every raw count.
+ */
+static bool fits(const ADS1115CalCoeff &coeff)
+{
+    int64_t low = -32768LL * coeff.mul + coeff.add;
+    int64_t high = 32767LL * coeff.mul + coeff.add;
+
+    return low >= -2147483647LL - 1 && high <= 2147483647LL;
+}
+
+/** Fold offset, gain and rounding into one multiply-add.
+ * uV = (raw - offset) * (uvMul / 2^uvShift) * gain, with the multiplier
+ * scaled by the largest 2^shift that stays under ADS1115_CAL_MUL_LIMIT.
+ */
+void ADS1115Calibration::fuse(Entry &entry)
+{
+    uint8_t pga = entry.key & 0x07;
+    uint8_t uvShift = ADS1115CFG::Tables::uvShift[pga];
+    int64_t base = (int64_t)ADS1115CFG::Tables::uvMul[pga] * entry.gain;
+    uint8_t shift = 0;
+    int64_t mul;
+
+    // mul = uvMul * gain * 2^(shift - uvShift - 24), rounded
+    while (shift < 24 && ((base << (shift + 1)) >> (uvShift + 24)) <
+                         ADS1115_CAL_MUL_LIMIT) {
+        shift++;
+    }
+    mul = ((base << shift) + (1LL << (uvShift + 23))) >> (uvShift + 24);
+
+    entry.coeff.mul = (int32_t)mul;
+    entry.coeff.shift = shift;
+    entry.coeff.add = (int32_t)(((shift ? 1LL << (shift - 1) : 0) * 16 -
+                                 (int64_t)entry.offset16 * mul + 8) >> 4);
+}
+
+/** Store corrections for one (mux, pga) pair, replacing any earlier ones.
+ * @param offset16 Reading at zero input, in 1/16 counts
+ * @param gain Correction factor, ADS1115_CAL_GAIN_ONE meaning none
+ * @return False if the table is full, gain is outside 0.5 .. 2.0 or the
+ *         offset is too large for the fused multiply-add at this gain
+ *         (it would overflow 32 bits for some raw counts)
+ */
+bool ADS1115Calibration::set(uint8_t mux, uint8_t pga, int32_t offset16,
+                             int32_t gain)
+{
+    uint8_t key = ((mux & 0x07) << 3) | (pga & 0x07);
+    Entry *entry = lookup(key);
+    Entry fused;
+
+    if (pga > ADS1115_PGA_0P256 || gain < ADS1115_CAL_GAIN_MIN ||
+        gain > ADS1115_CAL_GAIN_MAX || offset16 < -0x80000L ||
+        offset16 > 0x80000L) {
+        return false;
+    }
+    fused.key = key;
+    fused.offset16 = offset16;
+    fused.gain = gain;
+    fuse(fused);
+    if (!fits(fused.coeff)) {
+        return false;
+    }
+    if (!entry) {
+        if (count >= ADS1115_CAL_MAX_ENTRIES) {
+            return false;
+        }
+        entry = &entries[count++];
+    }
+    *entry = fused;
+    return true;
+}
+
+/** Stored corrections of a pair.
+ * @return False if the pair has none
+ */
+bool ADS1115Calibration::get(uint8_t mux, uint8_t pga, int32_t &offset16,
+                             int32_t &gain) const
+{
+    uint8_t key = ((mux & 0x07) << 3) | (pga & 0x07);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].key == key) {
+            offset16 = entries[i].offset16;
+            gain = entries[i].gain;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ADS1115Calibration::average(ADS1115 &adc, uint8_t mux, uint8_t pga,
+                                 uint16_t samples, int32_t &average16)
+{
+    ADS1115ScanChannel channel;
+    int32_t sum = 0;
+    int16_t raw;
+
+    channel.mux = mux;
+    channel.pga = pga;
+    if (samples == 0) {
+        return false;
+    }
+    for (uint16_t i = 0; i < samples; i++) {
+        if (adc.scan(&channel, 1, &raw) != 1) {
+            return false;
+        }
+        sum += raw;
+    }
+    // sum * 16 / samples, rounded half away from zero
+    average16 = (int32_t)(((int64_t)sum * 16 +
+                           (sum < 0 ? -(int32_t)samples : samples) / 2) /
+                          samples);
+    return true;
+}
+
+/** Measure the offset of a pair with its input shorted (or at a known
+ * zero). A gain stored earlier is kept.
+ * @param adc Device, left in single-shot mode
+ * @param samples Conversions to average
+ * @return False if a conversion timed out or the table is full
+ */
+bool ADS1115Calibration::captureOffset(ADS1115 &adc, uint8_t mux, uint8_t pga,
+                                       uint16_t samples)
+{
+    int32_t offset16, gain = ADS1115_CAL_GAIN_ONE;
+
+    get(mux, pga, offset16, gain);      // for the gain; offset16 is replaced
+    if (!average(adc, mux, pga, samples, offset16)) {
+        return false;
+    }
+    return set(mux, pga, offset16, gain);
+}
+
+/** Measure the gain of a pair against a known reference on its input.
+ * Capture the offset first; the gain is taken relative to it.
+ * @param referenceMicroVolts Applied reference, uV
+ * @return False on a timeout, an implausible reading or a full table
+ */
+bool ADS1115Calibration::captureGain(ADS1115 &adc, uint8_t mux, uint8_t pga,
+                                     int32_t referenceMicroVolts,
+                                     uint16_t samples)
+{
+    int32_t measured16, offset16 = 0, gain;
+    int64_t span, expected, ratio;
+
+    if (!average(adc, mux, pga, samples, measured16)) {
+        return false;
+    }
+    get(mux, pga, offset16, gain);
+    span = (int64_t)measured16 - offset16;
+    if (span == 0) {
+        return false;
+    }
+    // gain = expected counts / measured counts, both in 1/16 counts
+    expected = (int64_t)referenceMicroVolts *
+               (1LL << (ADS1115CFG::Tables::uvShift[pga & 0x07] + 4 + 24));
+    ratio = (expected / ADS1115CFG::Tables::uvMul[pga & 0x07]) / span;
+    // Range-check before narrowing, so a tiny span cannot wrap into range
+    if (ratio < ADS1115_CAL_GAIN_MIN || ratio > ADS1115_CAL_GAIN_MAX) {
+        return false;
+    }
+    gain = (int32_t)ratio;
+    return set(mux, pga, offset16, gain);
+}
+
+/** Serialize the table.
+ * @param blob Destination, at least getBlobSize() bytes
+ * @return Bytes written, 0 if size is too small
+ */
+size_t ADS1115Calibration::toBlob(uint8_t *blob, size_t size) const
+{
+    size_t length = getBlobSize();
+    uint8_t *p = blob;
+    uint16_t crc;
+
+    if (size < length) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        *p++ = calMagic[i];
+    }
+    *p++ = ADS1115_CAL_VERSION;
+    *p++ = count;
+    for (uint8_t i = 0; i < count; i++) {
+        *p++ = entries[i].key;
+        putLE32(p, entries[i].offset16);
+        putLE32(p + 4, entries[i].gain);
+        p += 8;
+    }
+    crc = ADS1115Crc16(blob, p - blob);
+    *p++ = crc & 0xFF;
+    *p++ = crc >> 8;
+    return length;
+}
+
+/** Load a table written by toBlob(). The current table is kept if the blob
+ * is truncated, corrupt or from another format version.
+ * @return False if the blob was rejected
+ */
+bool ADS1115Calibration::fromBlob(const uint8_t *blob, size_t size)
+{
+    ADS1115Calibration loaded;
+    const uint8_t *p = blob + ADS1115_CAL_HEADER_SIZE;
+    size_t length;
+
+    if (size < ADS1115_CAL_BLOB_SIZE(0)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        if (blob[i] != calMagic[i]) {
+            return false;
+        }
+    }
+    length = ADS1115_CAL_BLOB_SIZE(blob[5]);
+    if (blob[4] != ADS1115_CAL_VERSION || size < length ||
+        ADS1115Crc16(blob, length - 2) !=
+            (blob[length - 2] | (blob[length - 1] << 8))) {
+        return false;
+    }
+    for (uint8_t i = 0; i < blob[5]; i++, p += ADS1115_CAL_ENTRY_SIZE) {
+        if (!loaded.set(p[0] >> 3, p[0] & 0x07, getLE32(p + 1),
+                        getLE32(p + 5))) {
+            return false;
+        }
+    }
+    *this = loaded;
+    return true;
+}
+
+#if !defined(ARDUINO)
+bool ADS1115Calibration::saveFile(const char *path) const
+{
+    uint8_t blob[ADS1115_CAL_BLOB_SIZE(ADS1115_CAL_MAX_ENTRIES)];
+    size_t length = toBlob(blob, sizeof(blob));
+    FILE *file = fopen(path, "wb");
+    bool ok;
+
+    if (!file) {
+        return false;
+    }
+    ok = fwrite(blob, 1, length, file) == length;
+    return (fclose(file) == 0) && ok;
+}
+
+bool ADS1115Calibration::loadFile(const char *path)
+{
+    uint8_t blob[ADS1115_CAL_BLOB_SIZE(ADS1115_CAL_MAX_ENTRIES)];
+    FILE *file = fopen(path, "rb");
+    size_t length;
+
+    if (!file) {
+        return false;
+    }
+    length = fread(blob, 1, sizeof(blob), file);
+    fclose(file);
+    return fromBlob(blob, length);
+}
+#endif
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
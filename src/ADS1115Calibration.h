@@ -0,0 +1,154 @@
+#ifndef _ADS1115CALIBRATION_H_
+#define _ADS1115CALIBRATION_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+
+class ADS1115;
+
+// Calibrated (mux, pga) pairs; 8 MUX x 6 PGA settings exist in all
+#ifndef ADS1115_CAL_MAX_ENTRIES
+#if defined(__AVR__)
+#define ADS1115_CAL_MAX_ENTRIES     8
+#else
+#define ADS1115_CAL_MAX_ENTRIES     48
+#endif
+#endif
+
+#define ADS1115_CAL_GAIN_ONE        (1L << 24)  // unity gain correction
+#define ADS1115_CAL_VERSION         1
+// Blob: "ADSC", version, entry count, entries, CRC-16 of all before it
+#define ADS1115_CAL_HEADER_SIZE     6
+#define ADS1115_CAL_ENTRY_SIZE      9
+#define ADS1115_CAL_BLOB_SIZE(n)    (ADS1115_CAL_HEADER_SIZE + \
+                                     (n) * ADS1115_CAL_ENTRY_SIZE + 2)
+
+/** Fused raw -> uV transform of one (mux, pga) pair:
+ * uV = (raw * mul + add) >> shift, offset, gain and rounding folded in.
+ * The same single multiply-add and shift as the uncalibrated conversion.
+ */
+struct ADS1115CalCoeff {
+    int32_t mul;
+    int32_t add;
+    uint8_t shift;
+
+    int32_t apply(int16_t raw) const
+    {
+        return ((int32_t)raw * mul + add) >> shift;
+    }
+};
+
+/** Offset and gain corrections keyed by (mux, pga).
+ * Offsets are captured with the input shorted (or at a known zero), gains
+ * against a known reference voltage; both are kept as measured (offset in
+ * 1/16 counts, gain as a 2^24 fixed-point factor) and fused into an
+ * ADS1115CalCoeff whenever they change, so applying them costs nothing
+ * extra per sample. Hand the table to ADS1115::setCalibration() and
+ * getMicroVolts()/getMilliVolts() return corrected values.
+ *
+ * The table serializes to a small little-endian blob with a CRC, kept in
+ * EEPROM on Arduino or in a file on hosts. The EEPROM methods take the
+ * sketch's EEPROM object, so the library builds on cores without one.
+ */
+class ADS1115Calibration {
+    public:
+        ADS1115Calibration();
+
+        void clear();
+        bool set(uint8_t mux, uint8_t pga, int32_t offset16, int32_t gain);
+        bool get(uint8_t mux, uint8_t pga, int32_t &offset16,
+                 int32_t &gain) const;
+        uint8_t getCount() const { return count; }
+
+        bool captureOffset(ADS1115 &adc, uint8_t mux, uint8_t pga,
+                           uint16_t samples = 64);
+        bool captureGain(ADS1115 &adc, uint8_t mux, uint8_t pga,
+                         int32_t referenceMicroVolts, uint16_t samples = 64);
+
+        const ADS1115CalCoeff *find(uint8_t mux, uint8_t pga) const;
+        static ADS1115CalCoeff nominal(uint8_t pga);
+
+        size_t getBlobSize() const { return ADS1115_CAL_BLOB_SIZE(count); }
+        size_t toBlob(uint8_t *blob, size_t size) const;
+        bool fromBlob(const uint8_t *blob, size_t size);
+
+#if defined(ARDUINO)
+        template <class Eeprom>
+        bool saveEEPROM(Eeprom &eeprom, int address) const;
+        template <class Eeprom>
+        bool loadEEPROM(Eeprom &eeprom, int address);
+#else
+        bool saveFile(const char *path) const;
+        bool loadFile(const char *path);
+#endif
+
+    private:
+        struct Entry {
+            uint8_t key;            // mux << 3 | pga
+            int32_t offset16;       // offset, 1/16 counts
+            int32_t gain;           // ADS1115_CAL_GAIN_ONE = no correction
+            ADS1115CalCoeff coeff;
+        };
+
+        Entry *lookup(uint8_t key);
+        static void fuse(Entry &entry);
+        static bool average(ADS1115 &adc, uint8_t mux, uint8_t pga,
+                            uint16_t samples, int32_t &average16);
+
+        Entry   entries[ADS1115_CAL_MAX_ENTRIES];
+        uint8_t count;
+};
+
+#if defined(ARDUINO)
+/** Write the table to EEPROM, touching only bytes that change.
+ * @param eeprom The core's EEPROM object (include <EEPROM.h>, pass EEPROM)
+ * @param address First EEPROM byte
+ */
+template <class Eeprom>
+bool ADS1115Calibration::saveEEPROM(Eeprom &eeprom, int address) const
+{
+    uint8_t blob[ADS1115_CAL_BLOB_SIZE(ADS1115_CAL_MAX_ENTRIES)];
+    size_t length = toBlob(blob, sizeof(blob));
+
+    for (size_t i = 0; i < length; i++) {
+        if (eeprom.read(address + i) != blob[i]) {
+            eeprom.write(address + i, blob[i]);
+        }
+    }
+#if defined(ESP8266) || defined(ESP32)
+    return eeprom.commit();
+#else
+    return true;
+#endif
+}
+
+/** Load a table written by saveEEPROM().
+ * @param eeprom The core's EEPROM object
+ * @param address First EEPROM byte
+ * @return False (table unchanged) if no valid table is stored there
+ */
+template <class Eeprom>
+bool ADS1115Calibration::loadEEPROM(Eeprom &eeprom, int address)
+{
+    uint8_t blob[ADS1115_CAL_BLOB_SIZE(ADS1115_CAL_MAX_ENTRIES)];
+    size_t length = ADS1115_CAL_BLOB_SIZE(0);
+
+    for (size_t i = 0; i < sizeof(blob); i++) {
+        blob[i] = eeprom.read(address + i);
+        if (i == ADS1115_CAL_HEADER_SIZE - 1) {
+            if (blob[i] > ADS1115_CAL_MAX_ENTRIES) {
+                return false;
+            }
+            length = ADS1115_CAL_BLOB_SIZE(blob[i]);
+        }
+        if (i + 1 == length) {
+            break;
+        }
+    }
+    return fromBlob(blob, length);
+}
+#endif
+
+#endif /* _ADS1115CALIBRATION_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,233 @@
+#include "ADS1115.h"
+#include "ADS1115Coordinator.h"
+
+ADS1115Coordinator::ADS1115Coordinator()
+{
+    deviceCount = 0;
+    resetStats();
+}
+
+/** Add a device and the channels to convert on it each scan.
+ * @param adc Device; rate and comparator settings are taken as configured
+ * @param channels MUX/PGA list, kept by reference
+ * @param count Number of channels (1..ADS1115_COORDINATOR_MAX_CHANNELS)
+ * @return False if the coordinator is full or count is out of range
+ */
+bool ADS1115Coordinator::add(ADS1115 &adc, const ADS1115ScanChannel *channels,
+                             uint8_t count)
+{
+    if (deviceCount >= ADS1115_COORDINATOR_MAX_DEVICES || count == 0 ||
+        count > ADS1115_COORDINATOR_MAX_CHANNELS) {
+        return false;
+    }
+    Device &device = devices[deviceCount++];
+    device.adc = &adc;
+    device.channels = channels;
+    device.count = count;
+    return true;
+}
+
+/** Total number of channels over all devices (the size scan() fills).
+ */
+uint8_t ADS1115Coordinator::getChannelCount() const
+{
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        total += devices[i].count;
+    }
+    return total;
+}
+
+/** Channels of one device that the last scan() converted. The out[]
+ * entries of the others still hold whatever was there before.
+ * @param device Device index, in add() order
+ * @return Bit n set if channel n of the device's list was converted
+ */
+uint8_t ADS1115Coordinator::getValidMask(uint8_t device) const
+{
+    return devices[device].valid;
+}
+
+/** Latency statistics of one channel since the last resetStats().
+ * @param device Device index, in add() order
+ * @param channel Channel index within that device's list
+ */
+const ADS1115LatencyStats &ADS1115Coordinator::getLatency(uint8_t device,
+                                                          uint8_t channel) const
+{
+    return devices[device].latency[channel];
+}
+
+void ADS1115Coordinator::resetStats()
+{
+    for (uint8_t d = 0; d < ADS1115_COORDINATOR_MAX_DEVICES; d++) {
+        for (uint8_t c = 0; c < ADS1115_COORDINATOR_MAX_CHANNELS; c++) {
+            ADS1115LatencyStats &stats = devices[d].latency[c];
+            stats.count = 0;
+            stats.min = 0xFFFFFFFF;
+            stats.max = 0;
+            stats.total = 0;
+        }
+    }
+}
+
+/** Trigger the device's next channel. A channel whose trigger the device
+ * does not acknowledge is dropped and the one after it tried instead.
+ * @return False once the device has no channel left to start
+ */
+bool ADS1115Coordinator::start(Device &device)
+{
+    for (; device.next < device.count; device.next++) {
+        const ADS1115ScanChannel &channel = device.channels[device.next];
+
+        device.adc->setConfig(device.base | ADS1115_CFG_OS_BIT |
+            ((channel.mux << ADS1115_CFG_MUX_SHIFT) & ADS1115_CFG_MUX_MASK) |
+            ((channel.pga << ADS1115_CFG_PGA_SHIFT) & ADS1115_CFG_PGA_MASK));
+        if (device.adc->getBusStatus() == ADS1115_STATUS_OK) {
+            device.started = device.adc->getBus().micros();
+            device.pollAt = device.nominal;
+            device.backoff = device.nominal / 32;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Service one device if its conversion is due: poll once, and when ready
+ * start the next channel before reading the finished one.
+ * A conversion past the oscillator tolerance is polled on, up to twice
+ * that, rather than abandoned: the device ignores a trigger while it is
+ * busy and keeps the old MUX, so starting the next channel before OS is
+ * set would file the late result under the wrong channel. A device that
+ * never confirms is given up for the rest of the scan.
+ * @return True once the device has finished its list for this scan
+ */
+bool ADS1115Coordinator::service(Device &device, uint32_t now)
+{
+    uint32_t elapsed = now - device.started;
+    uint32_t limit = device.nominal +
+                     device.nominal * ADS1115_OSC_TOLERANCE_PCT / 100;
+    uint32_t started = device.started;
+    uint8_t done = device.next;
+    bool more;
+    int16_t value;
+
+    if (elapsed < device.pollAt) {
+        return false;
+    }
+    if (!device.adc->isConversionReady()) {
+        if (elapsed >= 2 * limit) {
+            // still busy or not answering: nothing is known to be safe
+            return true;
+        }
+        device.pollAt = elapsed + device.backoff;
+        if (elapsed < limit && device.pollAt > limit) {
+            device.pollAt = limit;
+        }
+        if (device.backoff < device.nominal / 8) {
+            device.backoff *= 2;
+        }
+        return false;
+    }
+
+    device.next++;
+    more = start(device);
+    value = device.adc->getConversion(false);
+    if (device.adc->getBusStatus() != ADS1115_STATUS_OK) {
+        return !more;
+    }
+    device.out[done] = value;
+    device.converted++;
+    device.valid |= 1 << done;
+
+    ADS1115LatencyStats &stats = device.latency[done];
+    uint32_t latency = device.adc->getBus().micros() - started;
+    stats.count++;
+    stats.total += latency;
+    if (latency < stats.min) {
+        stats.min = latency;
+    }
+    if (latency > stats.max) {
+        stats.max = latency;
+    }
+    return !more;
+}
+
+/** Convert every device's channel list once, devices in parallel.
+ * @param out Raw results, device by device in add() order, each device's
+ *        channels in list order (getChannelCount() entries)
+ * @return Number of channels converted (fewer than getChannelCount() if
+ *         some conversions timed out or a device did not answer; see
+ *         getValidMask() for which)
+ */
+uint8_t ADS1115Coordinator::scan(int16_t *out)
+{
+    bool active[ADS1115_COORDINATOR_MAX_DEVICES];
+    uint8_t remaining = deviceCount;
+    uint8_t converted = 0;
+
+    if (deviceCount == 0) {
+        return 0;
+    }
+    ADS1115Bus &clock = devices[0].adc->getBus();
+
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        Device &device = devices[i];
+        uint16_t config = device.adc->getConfig();
+        uint8_t rate;
+
+        if (device.adc->getBusStatus() != ADS1115_STATUS_OK) {
+            // may be left over from an earlier access: read CONFIG afresh
+            device.adc->invalidate();
+            config = device.adc->getConfig();
+        }
+        rate = (config & ADS1115_CFG_DR_MASK) >> ADS1115_CFG_DR_SHIFT;
+        device.base = (config & ~(ADS1115_CFG_MUX_MASK |
+                                  ADS1115_CFG_PGA_MASK)) |
+                      ADS1115_CFG_MODE_BIT;
+        device.nominal = ADS1115::getConversionTime(rate) + ADS1115_WAKEUP_US;
+        device.out = out;
+        device.next = 0;
+        device.converted = 0;
+        device.valid = 0;
+        out += device.count;
+        // Never trigger with a guessed CONFIG: sit this scan out
+        active[i] = device.adc->getBusStatus() == ADS1115_STATUS_OK &&
+                    start(device);
+        if (!active[i]) {
+            remaining--;
+        }
+    }
+
+    while (remaining) {
+        uint32_t now = clock.micros();
+        uint32_t wait = 0xFFFFFFFF;
+
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            if (active[i] && service(devices[i], now)) {
+                active[i] = false;
+                converted += devices[i].converted;
+                remaining--;
+            }
+        }
+
+        now = clock.micros();
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            if (!active[i]) {
+                continue;
+            }
+            uint32_t elapsed = now - devices[i].started;
+            uint32_t due = elapsed >= devices[i].pollAt ?
+                           0 : devices[i].pollAt - elapsed;
+            if (due < wait) {
+                wait = due;
+            }
+        }
+        if (remaining && wait > 0) {
+            clock.sleepMicros(wait);
+        }
+    }
+    return converted;
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
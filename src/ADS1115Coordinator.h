@@ -0,0 +1,82 @@
+#ifndef _ADS1115COORDINATOR_H_
+#define _ADS1115COORDINATOR_H_
+
+#include <inttypes.h>
+
+class ADS1115;
+struct ADS1115ScanChannel;
+
+// Four addresses per bus; hosts may spread devices over several buses.
+#ifndef ADS1115_COORDINATOR_MAX_DEVICES
+#if defined(ARDUINO)
+#define ADS1115_COORDINATOR_MAX_DEVICES     4
+#else
+#define ADS1115_COORDINATOR_MAX_DEVICES     16
+#endif
+#endif
+#define ADS1115_COORDINATOR_MAX_CHANNELS    8
+
+/** Trigger-to-result latency of one channel, in us.
+ */
+struct ADS1115LatencyStats {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t total;
+};
+
+/** Runs the channel lists of several devices with their conversions
+ * overlapped.
+ * Every device gets its first conversion started back to back; after that
+ * each device is serviced in completion order: once its conversion is due
+ * and confirmed, the next channel's CONFIG+OS goes out first and the
+ * finished result is read while that conversion runs. N devices therefore
+ * convert in parallel and a scan takes about as long as the longest single
+ * device list. A device only gets its next channel once OS confirms the
+ * previous conversion is over; one that stays busy or silent for twice the
+ * oscillator tolerance is left out of the rest of the scan. All devices
+ * must share one clock (same bus type).
+ */
+class ADS1115Coordinator {
+    public:
+        ADS1115Coordinator();
+
+        bool add(ADS1115 &adc, const ADS1115ScanChannel *channels,
+                 uint8_t count);
+        uint8_t getDeviceCount() const { return deviceCount; }
+        uint8_t getChannelCount() const;
+
+        uint8_t scan(int16_t *out);
+        uint8_t getValidMask(uint8_t device) const;
+
+        const ADS1115LatencyStats &getLatency(uint8_t device,
+                                              uint8_t channel) const;
+        void resetStats();
+
+    private:
+        struct Device {
+            ADS1115 *adc;
+            const ADS1115ScanChannel *channels;
+            uint8_t  count;
+            uint8_t  next;          // channel whose result is pending
+            uint16_t base;          // CONFIG bits shared by every channel
+            uint8_t  converted;
+            uint8_t  valid;         // bit n = channel n converted
+            uint32_t started;       // bus clock at the last trigger
+            uint32_t nominal;       // conversion time + wake-up, us
+            uint32_t pollAt;        // next poll, us after started
+            uint32_t backoff;
+            int16_t *out;
+            ADS1115LatencyStats latency[ADS1115_COORDINATOR_MAX_CHANNELS];
+        };
+
+        bool start(Device &device);
+        bool service(Device &device, uint32_t now);
+
+        Device  devices[ADS1115_COORDINATOR_MAX_DEVICES];
+        uint8_t deviceCount;
+};
+
+#endif /* _ADS1115COORDINATOR_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
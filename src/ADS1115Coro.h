@@ -0,0 +1,211 @@
+#ifndef _ADS1115CORO_H_
+#define _ADS1115CORO_H_
+
+// C++20 coroutine adapter over ADS1115::startConversion()/poll(). Host
+// builds only; on anything older this header is empty.
+
+#if !defined(ARDUINO) && __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <vector>
+#include "ADS1115.h"
+
+/** Coroutine return type for acquisition tasks.
+ * Starts running immediately and frees itself when it returns; it is
+ * resumed by the ADS1115Scheduler it awaits on.
+ */
+struct ADS1115Task {
+    struct promise_type {
+        ADS1115Task get_return_object() { return ADS1115Task(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/** Single-threaded executor for conversions awaited from coroutines.
+ * Many tasks can wait on many devices; run() polls each in-flight
+ * conversion when it is due, resumes the task that awaited it, and sleeps
+ * on the bus clock in between. A device converts one request at a time;
+ * further requests for it queue in arrival order, in a per-device FIFO, so
+ * a pass costs one step per device however many tasks are waiting. Devices
+ * may sit on different buses; run() sleeps on whichever bus has the next
+ * conversion due, which also drives separate simulated clocks forward. To
+ * spread devices over a few threads, give each thread its own scheduler and
+ * its own devices.
+ *
+ *     ADS1115Task reader(ADS1115Scheduler &s, ADS1115 &adc) {
+ *         for (;;) {
+ *             ADS1115Conversion c = co_await s.convert(adc,
+ *                 ADS1115_MUX_P0_NG, ADS1115_PGA_2P048, ADS1115_RATE_860);
+ *             ...
+ *         }
+ *     }
+ */
+class ADS1115Scheduler {
+    public:
+        class Awaiter {
+            public:
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> handle)
+                {
+                    this->handle = handle;
+                    scheduler->enqueue(this);
+                }
+                ADS1115Conversion await_resume() const noexcept
+                {
+                    return conversion;
+                }
+
+            private:
+                friend class ADS1115Scheduler;
+
+                Awaiter(ADS1115Scheduler *scheduler, ADS1115 *adc,
+                        uint8_t mux, uint8_t pga, uint8_t rate)
+                    : scheduler(scheduler), adc(adc), mux(mux), pga(pga),
+                      rate(rate), next(0)
+                {
+                    conversion.status = ADS1115_STATUS_PENDING;
+                }
+
+                ADS1115Scheduler *scheduler;
+                ADS1115 *adc;
+                uint8_t mux, pga, rate;
+                Awaiter *next;          // behind this one on the device
+                ADS1115Conversion conversion;
+                std::coroutine_handle<> handle;
+        };
+
+        ADS1115Scheduler() : waiting(0) {}
+
+        /** Await a single-shot conversion.
+         * @return Awaitable yielding the finished ADS1115Conversion
+         */
+        Awaiter convert(ADS1115 &adc, uint8_t mux, uint8_t pga, uint8_t rate)
+        {
+            return Awaiter(this, &adc, mux, pga, rate);
+        }
+
+        /** Poll and complete whatever is due, without sleeping. A device
+         * whose request finishes starts its next queued one straight away.
+         * @return Number of tasks resumed
+         */
+        unsigned runOnce()
+        {
+            done.clear();
+            for (Device &device : devices) {
+                Awaiter *head = device.head;
+                if (!head || head->adc->poll(head->conversion) ==
+                             ADS1115_STATUS_PENDING) {
+                    continue;
+                }
+                device.head = head->next;
+                if (!device.head) {
+                    device.tail = 0;
+                } else {
+                    start(device.head);
+                }
+                waiting--;
+                done.push_back(head);
+            }
+
+            // Resume after the pass: a task may queue its next request
+            // from inside resume(), which may add a device.
+            for (size_t i = 0; i < done.size(); i++) {
+                done[i]->handle.resume();
+            }
+            return done.size();
+        }
+
+        /** Run until no task is waiting on a conversion.
+         */
+        void run()
+        {
+            while (waiting) {
+                if (runOnce() > 0) {
+                    continue;
+                }
+                ADS1115Bus *bus = 0;
+                uint32_t wait = nextDue(bus);
+                if (wait > 0 && bus) {
+                    bus->sleepMicros(wait);
+                }
+            }
+        }
+
+        size_t pending() const
+        {
+            return waiting;
+        }
+
+    private:
+        struct Device {
+            ADS1115 *adc;
+            Awaiter *head;          // in flight
+            Awaiter *tail;
+        };
+
+        void start(Awaiter *awaiter)
+        {
+            awaiter->conversion = awaiter->adc->startConversion(
+                awaiter->mux, awaiter->pga, awaiter->rate);
+        }
+
+        void enqueue(Awaiter *awaiter)
+        {
+            Device *device = 0;
+
+            for (Device &d : devices) {
+                if (d.adc == awaiter->adc) {
+                    device = &d;
+                    break;
+                }
+            }
+            if (!device) {
+                devices.push_back(Device{ awaiter->adc, 0, 0 });
+                device = &devices.back();
+            }
+            waiting++;
+            if (device->tail) {
+                device->tail->next = awaiter;
+                device->tail = awaiter;
+                return;
+            }
+            device->head = device->tail = awaiter;
+            start(awaiter);
+        }
+
+        // Microseconds until the earliest in-flight conversion is due, and
+        // the bus whose clock it runs on
+        uint32_t nextDue(ADS1115Bus *&bus) const
+        {
+            uint32_t wait = 0xFFFFFFFF;
+
+            for (const Device &device : devices) {
+                if (!device.head) {
+                    continue;
+                }
+                const ADS1115Conversion &c = device.head->conversion;
+                ADS1115Bus &clock = device.adc->getBus();
+                uint32_t elapsed = clock.micros() - c.started;
+                uint32_t due = elapsed >= c.pollAt ? 0 : c.pollAt - elapsed;
+                if (due < wait) {
+                    wait = due;
+                    bus = &clock;
+                }
+            }
+            return wait;
+        }
+
+        std::vector<Device> devices;
+        std::vector<Awaiter *> done;
+        size_t waiting;
+};
+
+#endif
+
+#endif /* _ADS1115CORO_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,14 @@
+#include "ADS1115Crc.h"
+
+uint16_t ADS1115Crc16(const uint8_t *data, size_t len, uint16_t crc)
+{
+    while (len--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
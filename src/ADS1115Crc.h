@@ -0,0 +1,18 @@
+#ifndef _ADS1115CRC_H_
+#define _ADS1115CRC_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#define ADS1115_CRC16_INIT          0xFFFF
+
+/** CRC-16/CCITT-FALSE (poly 0x1021, MSB first) used by the calibration
+ * blob and the log format. Pass the previous result as crc to continue
+ * over several pieces.
+ */
+uint16_t ADS1115Crc16(const uint8_t *data, size_t len,
+                      uint16_t crc = ADS1115_CRC16_INIT);
+
+#endif /* _ADS1115CRC_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,275 @@
+#ifndef _ADS1115FILTER_H_
+#define _ADS1115FILTER_H_
+
+#include <inttypes.h>
+#include "ADS1115CFG.h"
+
+// -----------------------------------------------------------------------------
+// Integer filters for raw conversion results, one instance per channel.
+// Every filter keeps fixed storage and does a bounded amount of work per
+// sample. Outputs are raw counts with ADS1115_FILTER_FRAC_BITS fractional
+// bits, so averaging gains resolution below one LSB instead of losing it to
+// rounding.
+// -----------------------------------------------------------------------------
+
+#define ADS1115_FILTER_FRAC_BITS    4
+#define ADS1115_FILTER_ONE          (1L << ADS1115_FILTER_FRAC_BITS)
+
+namespace ADS1115CFG {
+
+/** DC gain R^M of a CIC decimator.
+ */
+constexpr uint32_t cicGain(uint16_t r, uint8_t m)
+{
+    return m == 0 ? 1 : (uint32_t)r * cicGain(r, m - 1);
+}
+
+constexpr uint8_t log2Floor(uint32_t x)
+{
+    return x <= 1 ? 0 : 1 + log2Floor(x >> 1);
+}
+
+} // namespace ADS1115CFG
+
+/** Common interface, so the driver can feed any filter.
+ * @see ADS1115::getFilteredConversion()
+ */
+class ADS1115Filter {
+    public:
+        virtual ~ADS1115Filter() {}
+
+        /** Feed one raw sample.
+         * @param raw Conversion result
+         * @param out Filtered value (counts << ADS1115_FILTER_FRAC_BITS),
+         *        written only when an output is produced
+         * @return True if out was written (decimators: every R-th sample)
+         */
+        virtual bool push(int16_t raw, int32_t &out) = 0;
+        virtual void reset() = 0;
+
+        /** Filtered value to microvolts for the given PGA code, rounded.
+         */
+        static int32_t toMicroVolts(int32_t value, uint8_t pga)
+        {
+            uint8_t shift = ADS1115CFG::Tables::uvShift[pga & 0x07] +
+                            ADS1115_FILTER_FRAC_BITS;
+            return (value * (int32_t)ADS1115CFG::Tables::uvMul[pga & 0x07] +
+                    (1L << (shift - 1))) >> shift;
+        }
+
+        /** Filtered value rounded back to whole counts.
+         */
+        static int16_t toCounts(int32_t value)
+        {
+            return (int16_t)((value + (ADS1115_FILTER_ONE >> 1)) >>
+                             ADS1115_FILTER_FRAC_BITS);
+        }
+};
+
+/** Moving average over the last N samples, one output per input.
+ * Keeps a running sum, so each sample costs one add and one subtract.
+ * Until N samples have arrived the average covers those seen so far.
+ */
+template <uint8_t N>
+class ADS1115Boxcar : public ADS1115Filter {
+    public:
+        ADS1115Boxcar() { reset(); }
+
+        bool push(int16_t raw, int32_t &out)
+        {
+            if (filled == N) {
+                sum -= window[index];
+            } else {
+                filled++;
+            }
+            window[index] = raw;
+            sum += raw;
+            index = (index + 1 == N) ? 0 : index + 1;
+            out = (sum * ADS1115_FILTER_ONE) / filled;
+            return true;
+        }
+
+        void reset()
+        {
+            sum = 0;
+            index = 0;
+            filled = 0;
+        }
+
+    private:
+        static_assert(N >= 1, "boxcar needs at least one tap");
+
+        int16_t window[N];
+        int32_t sum;
+        uint8_t index;
+        uint8_t filled;
+};
+
+/** CIC (cascaded integrator-comb) decimator of order M, rate change R and
+ * differential delay 1: a cascade of M boxcars of length R, computed with
+ * M integrators and M combs and no multiplies. One output per R inputs.
+ * Integrators wrap on purpose; modular arithmetic makes the combs recover
+ * the exact result as long as the gain R^M fits, which is checked at
+ * compile time.
+ */
+template <uint16_t R, uint8_t M = 3>
+class ADS1115CicDecimator : public ADS1115Filter {
+    public:
+        ADS1115CicDecimator() { reset(); }
+
+        bool push(int16_t raw, int32_t &out)
+        {
+            uint32_t value = (uint32_t)(int32_t)raw;
+
+            for (uint8_t i = 0; i < M; i++) {
+                integrator[i] += value;
+                value = integrator[i];
+            }
+            if (++phase < R) {
+                return false;
+            }
+            phase = 0;
+            for (uint8_t i = 0; i < M; i++) {
+                uint32_t previous = comb[i];
+                comb[i] = value;
+                value -= previous;
+            }
+            out = scale((int32_t)value);
+            return true;
+        }
+
+        void reset()
+        {
+            for (uint8_t i = 0; i < M; i++) {
+                integrator[i] = 0;
+                comb[i] = 0;
+            }
+            phase = 0;
+        }
+
+    private:
+        static constexpr uint32_t GAIN = ADS1115CFG::cicGain(R, M);
+        static constexpr uint8_t GAIN_LOG2 = ADS1115CFG::log2Floor(GAIN);
+        static constexpr bool GAIN_SHIFTS = (GAIN & (GAIN - 1)) == 0 &&
+                                GAIN_LOG2 > ADS1115_FILTER_FRAC_BITS;
+        static constexpr uint8_t SCALE_SHIFT =
+            GAIN_SHIFTS ? GAIN_LOG2 - ADS1115_FILTER_FRAC_BITS : 1;
+
+        static_assert(R >= 2, "decimation ratio must be at least 2");
+        static_assert(M >= 1 && M <= 4, "CIC order must be 1..4");
+        // 16 input bits plus M*log2(R) growth must fit in 32 bits
+        static_assert((uint64_t)GAIN * 32768ULL < 0x80000000ULL,
+                      "R^M too large for 32-bit CIC registers");
+
+        // Divide out the gain, keeping ADS1115_FILTER_FRAC_BITS; a shift
+        // when R is a power of two, a 64-bit divide otherwise
+        static int32_t scale(int32_t sum)
+        {
+            if (GAIN_SHIFTS) {
+                return (sum + (1L << (SCALE_SHIFT - 1))) >> SCALE_SHIFT;
+            }
+            return (int32_t)(((int64_t)sum * ADS1115_FILTER_ONE) /
+                             (int64_t)GAIN);
+        }
+
+        uint32_t integrator[M];
+        uint32_t comb[M];
+        uint16_t phase;
+};
+
+/** Exponential moving average, y += (x - y) / 2^SHIFT.
+ * The state carries SHIFT extra bits, so small steps are not lost to
+ * truncation. Time constant is about 2^SHIFT samples.
+ */
+template <uint8_t SHIFT>
+class ADS1115Ema : public ADS1115Filter {
+    public:
+        ADS1115Ema() { reset(); }
+
+        bool push(int16_t raw, int32_t &out)
+        {
+            int32_t x = (int32_t)raw * ADS1115_FILTER_ONE;
+
+            if (!primed) {
+                state = x * (1L << SHIFT);
+                primed = true;
+            } else {
+                state += x - (state >> SHIFT);
+            }
+            out = state >> SHIFT;
+            return true;
+        }
+
+        void reset()
+        {
+            state = 0;
+            primed = false;
+        }
+
+    private:
+        static_assert(SHIFT >= 1 && SHIFT <= 11,
+                      "EMA shift must be 1..11 to fit 32 bits");
+
+        int32_t state;
+        bool primed;
+};
+
+/** Running median of the last N samples (N odd), for knocking out spikes
+ * before averaging. Keeps the window both in arrival order and sorted;
+ * each sample moves at most N entries.
+ */
+template <uint8_t N>
+class ADS1115Median : public ADS1115Filter {
+    public:
+        ADS1115Median() { reset(); }
+
+        bool push(int16_t raw, int32_t &out)
+        {
+            uint8_t pos;
+
+            if (filled == N) {
+                // drop the oldest sample from the sorted copy
+                int16_t oldest = window[index];
+                for (pos = 0; sorted[pos] != oldest; pos++) {
+                }
+                for (; pos + 1 < N; pos++) {
+                    sorted[pos] = sorted[pos + 1];
+                }
+                filled--;
+            }
+            window[index] = raw;
+            index = (index + 1 == N) ? 0 : index + 1;
+
+            for (pos = filled; pos > 0 && sorted[pos - 1] > raw; pos--) {
+                sorted[pos] = sorted[pos - 1];
+            }
+            sorted[pos] = raw;
+            filled++;
+
+            if (filled & 1) {
+                out = (int32_t)sorted[filled / 2] * ADS1115_FILTER_ONE;
+            } else {
+                out = ((int32_t)sorted[filled / 2 - 1] + sorted[filled / 2]) *
+                      (ADS1115_FILTER_ONE / 2);
+            }
+            return true;
+        }
+
+        void reset()
+        {
+            index = 0;
+            filled = 0;
+        }
+
+    private:
+        static_assert(N >= 3 && (N & 1), "median window must be odd, >= 3");
+
+        int16_t window[N];
+        int16_t sorted[N];
+        uint8_t index;
+        uint8_t filled;
+};
+
+#endif /* _ADS1115FILTER_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,355 @@
+#if defined(ARDUINO)
+#include "Arduino.h"
+#endif
+#include <string.h>
+
+#include "ADS1115.h"
+#include "ADS1115Crc.h"
+#include "ADS1115Frame.h"
+
+static uint8_t countChannels(uint16_t mask)
+{
+    uint8_t count = 0;
+
+    while (mask) {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+}
+
+static uint16_t getLE16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t getLE32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void putLE32(uint8_t *p, uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+#if defined(ARDUINO)
+static size_t printSink(void *out, const uint8_t *data, size_t len)
+{
+    return ((Print *)out)->write(data, len);
+}
+
+/** Sender writing packets to a Print (Serial ...).
+ */
+ADS1115FrameSender::ADS1115FrameSender(Print &out)
+{
+    sink = printSink;
+    context = &out;
+    channelCount = 0;
+    packets = 0;
+    errors = 0;
+}
+#endif
+
+/** Sender writing packets to a sink.
+ * @param sink Byte sink
+ * @param context Passed to every sink call
+ */
+ADS1115FrameSender::ADS1115FrameSender(ADS1115FrameSink sink, void *context)
+{
+    this->sink = sink;
+    this->context = context;
+    channelCount = 0;
+    packets = 0;
+    errors = 0;
+}
+
+/** Start a stream for a channel set.
+ * Pending frames of an earlier stream are flushed first, and the sequence
+ * number restarts at 0.
+ * @param channelMask Channels carried, bit n = channel n (application-
+ *        defined, e.g. device * 4 + input)
+ * @param framesPerPacket Frames to collect before a packet is sent;
+ *        clamped to what fits in ADS1115_FRAME_BUFFER_SIZE
+ * @param flags ADS1115_FRAME_SEQUENCE and/or ADS1115_FRAME_CRC
+ * @return False if the mask is empty or one frame does not fit
+ */
+bool ADS1115FrameSender::begin(uint16_t channelMask, uint8_t framesPerPacket,
+                               uint8_t flags)
+{
+    uint8_t count = countChannels(channelMask);
+    uint16_t fit;
+
+    if (count == 0 || count * 2 > ADS1115_FRAME_BUFFER_SIZE) {
+        return false;
+    }
+    if (channelCount) {
+        flush();
+    }
+    fit = ADS1115_FRAME_BUFFER_SIZE / (count * 2);
+    if (framesPerPacket == 0) {
+        framesPerPacket = 1;
+    }
+    if (framesPerPacket > fit) {
+        framesPerPacket = (uint8_t)fit;
+    }
+    this->channelMask = channelMask;
+    this->framesPerPacket = framesPerPacket;
+    this->flags = flags & (ADS1115_FRAME_SEQUENCE | ADS1115_FRAME_CRC);
+    channelCount = count;
+    frames = 0;
+    sequence = 0;
+    used = ADS1115_FRAME_HEADER_SIZE +
+           (this->flags & ADS1115_FRAME_SEQUENCE ? 2 : 0);
+    return true;
+}
+
+/** Add one frame, sending the packet once it is full.
+ * @param frame One raw sample per channel, in bit order of the mask
+ * @param timestampUs Sample time on a micros()-style clock
+ * @return False if begin() was not called or the sink failed
+ */
+bool ADS1115FrameSender::append(const int16_t *frame, uint32_t timestampUs)
+{
+    if (!channelCount) {
+        return false;
+    }
+    if (frames == 0) {
+        firstUs = timestampUs;
+    }
+    lastUs = timestampUs;
+    for (uint8_t c = 0; c < channelCount; c++) {
+        buffer[used++] = (uint8_t)frame[c];
+        buffer[used++] = (uint8_t)((uint16_t)frame[c] >> 8);
+    }
+    if (++frames < framesPerPacket) {
+        return true;
+    }
+    return flush();
+}
+
+/** Scan a device and add the results as one frame.
+ * @param channels One scan entry per channel of the mask
+ * @param timestampUs Frame time; typically micros() before the scan
+ * @return False if the scan timed out (nothing is added) or the sink failed
+ * @see ADS1115::scan()
+ */
+bool ADS1115FrameSender::appendScan(ADS1115 &adc,
+                                    const ADS1115ScanChannel *channels,
+                                    uint32_t timestampUs)
+{
+    int16_t frame[ADS1115_FRAME_MAX_CHANNELS];
+
+    if (!channelCount ||
+        adc.scan(channels, channelCount, frame) != channelCount) {
+        return false;
+    }
+    return append(frame, timestampUs);
+}
+
+/** Send the pending frames now, even if the packet is not full.
+ * @return False if the sink failed (the frames are dropped either way)
+ */
+bool ADS1115FrameSender::flush()
+{
+    bool ok;
+
+    if (!channelCount || frames == 0) {
+        return true;
+    }
+    buffer[0] = ADS1115_FRAME_SYNC0;
+    buffer[1] = ADS1115_FRAME_SYNC1;
+    buffer[2] = (ADS1115_FRAME_VERSION << 4) | flags;
+    buffer[3] = frames;
+    buffer[4] = channelMask & 0xFF;
+    buffer[5] = channelMask >> 8;
+    putLE32(buffer + 6, firstUs);
+    putLE32(buffer + 10, lastUs - firstUs);
+    if (flags & ADS1115_FRAME_SEQUENCE) {
+        buffer[14] = sequence & 0xFF;
+        buffer[15] = sequence >> 8;
+    }
+    if (flags & ADS1115_FRAME_CRC) {
+        uint16_t crc = ADS1115Crc16(buffer + 2, used - 2);
+        buffer[used++] = crc & 0xFF;
+        buffer[used++] = crc >> 8;
+    }
+
+    ok = sink(context, buffer, used) == used;
+    sequence++;
+    packets++;
+    if (!ok) {
+        errors++;
+    }
+    frames = 0;
+    used = ADS1115_FRAME_HEADER_SIZE + (flags & ADS1115_FRAME_SEQUENCE ? 2 : 0);
+    return ok;
+}
+
+ADS1115FrameDecoder::ADS1115FrameDecoder()
+{
+    packets = 0;
+    crcErrors = 0;
+    skipped = 0;
+    lost = 0;
+    resyncs = 0;
+    reset();
+}
+
+/** Discard buffered bytes and forget the sequence (counters are kept).
+ */
+void ADS1115FrameDecoder::reset()
+{
+    have = 0;
+    headerSize = ADS1115_FRAME_HEADER_SIZE;
+    channelCount = 0;
+    complete = false;
+    synced = false;
+    buffer[3] = 0;
+}
+
+/** Drop the bad start of the buffer, up to the next candidate sync.
+ */
+void ADS1115FrameDecoder::drop()
+{
+    const uint8_t *next = (const uint8_t *)memchr(buffer + 1,
+                                                  ADS1115_FRAME_SYNC0,
+                                                  have - 1);
+    uint16_t cut = next ? (uint16_t)(next - buffer) : have;
+
+    skipped += cut;
+    have -= cut;
+    memmove(buffer, buffer + cut, have);
+}
+
+/** Take one received byte.
+ * @return True if it completed a valid packet
+ */
+bool ADS1115FrameDecoder::push(uint8_t byte)
+{
+    if (complete) {
+        have = 0;
+        complete = false;
+    }
+    buffer[have++] = byte;
+
+    while (have > 0) {
+        uint8_t flags, count;
+        uint16_t payload, length;
+
+        if (buffer[0] != ADS1115_FRAME_SYNC0 ||
+            (have > 1 && buffer[1] != ADS1115_FRAME_SYNC1)) {
+            drop();
+            continue;
+        }
+        if (have < ADS1115_FRAME_HEADER_SIZE) {
+            return false;
+        }
+        flags = buffer[2];
+        count = countChannels(getLE16(buffer + 4));
+        payload = (uint16_t)buffer[3] * count * 2;
+        if ((flags >> 4) != ADS1115_FRAME_VERSION ||
+            (flags & 0x0C) || buffer[3] == 0 || count == 0 ||
+            payload > ADS1115_FRAME_BUFFER_SIZE) {
+            drop();
+            continue;
+        }
+        headerSize = ADS1115_FRAME_HEADER_SIZE +
+                     (flags & ADS1115_FRAME_SEQUENCE ? 2 : 0);
+        length = headerSize + payload + (flags & ADS1115_FRAME_CRC ? 2 : 0);
+        if (have < length) {
+            return false;
+        }
+        if ((flags & ADS1115_FRAME_CRC) &&
+            ADS1115Crc16(buffer + 2, length - 4) !=
+                getLE16(buffer + length - 2)) {
+            crcErrors++;
+            drop();
+            continue;
+        }
+
+        channelCount = count;
+        if (flags & ADS1115_FRAME_SEQUENCE) {
+            uint16_t sequence = getLE16(buffer + 14);
+            uint16_t gap = (uint16_t)(sequence - nextSequence);
+            if (synced && gap < 0x8000) {
+                lost += gap;
+            } else if (synced) {
+                // Backwards: a restarted sender, a repeat or a packet out
+                // of order. Follow the new numbering without counting it.
+                resyncs++;
+            }
+            nextSequence = sequence + 1;
+            synced = true;
+        }
+        packets++;
+        complete = true;
+        return true;
+    }
+    return false;
+}
+
+/** Take received bytes up to the end of the next complete packet.
+ * @param ready Set if a packet was completed; read it before feeding the
+ *        rest
+ * @return Bytes consumed
+ */
+size_t ADS1115FrameDecoder::feed(const uint8_t *data, size_t len, bool &ready)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (push(data[i])) {
+            ready = true;
+            return i + 1;
+        }
+    }
+    ready = false;
+    return len;
+}
+
+uint16_t ADS1115FrameDecoder::getChannelMask() const
+{
+    return getLE16(buffer + 4);
+}
+
+uint32_t ADS1115FrameDecoder::getTimestamp() const
+{
+    return getLE32(buffer + 6);
+}
+
+/** Time of one frame, interpolated between the first and the last.
+ */
+uint32_t ADS1115FrameDecoder::getFrameTimestamp(uint8_t frame) const
+{
+    uint8_t count = getFrameCount();
+
+    if (count < 2) {
+        return getTimestamp();
+    }
+    return getTimestamp() +
+           (uint32_t)((uint64_t)getLE32(buffer + 10) * frame / (count - 1));
+}
+
+bool ADS1115FrameDecoder::hasSequence() const
+{
+    return (buffer[2] & ADS1115_FRAME_SEQUENCE) != 0;
+}
+
+uint16_t ADS1115FrameDecoder::getSequence() const
+{
+    return hasSequence() ? getLE16(buffer + 14) : 0;
+}
+
+/** One sample of the current packet.
+ * @param frame 0..getFrameCount()-1
+ * @param slot 0..getChannelCount()-1, in bit order of the channel mask
+ */
+int16_t ADS1115FrameDecoder::getSample(uint8_t frame, uint8_t slot) const
+{
+    return (int16_t)getLE16(buffer + headerSize +
+                            ((uint16_t)frame * channelCount + slot) * 2);
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,157 @@
+#ifndef _ADS1115FRAME_H_
+#define _ADS1115FRAME_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#if defined(ARDUINO)
+class Print;
+#endif
+class ADS1115;
+struct ADS1115ScanChannel;
+
+// -----------------------------------------------------------------------------
+// Binary streaming packets, for serial links. A packet carries one or more
+// frames of raw samples (one per enabled channel) taken at evenly spaced
+// times. All fields are little-endian.
+//
+//   offset  size  field
+//        0     2  sync 0xA5 0x5A
+//        2     1  flags: ADS1115_FRAME_SEQUENCE, ADS1115_FRAME_CRC and the
+//                 format version in the top nibble
+//        3     1  frame count F (1..255)
+//        4     2  channel bitmap; bit n set = channel n present, C = bits set
+//        6     4  timestamp of the first frame, us (wraps like micros())
+//       10     4  last frame time - first frame time, us
+//      [14     2  packet sequence number, if ADS1115_FRAME_SEQUENCE]
+//        H  2*F*C samples, int16_t, frame by frame in channel order
+//     [H+2FC   2  CRC-16 (ADS1115Crc16) of flags..samples, if ADS1115_FRAME_CRC]
+//
+// A packet without a CRC cannot be checked; the decoder then relies on the
+// sync bytes and the header fields alone. Version 1 packets had a 16-bit
+// span, which saturated at 65.5 ms; they are not accepted.
+// -----------------------------------------------------------------------------
+
+#define ADS1115_FRAME_SYNC0         0xA5
+#define ADS1115_FRAME_SYNC1         0x5A
+#define ADS1115_FRAME_VERSION       2
+#define ADS1115_FRAME_HEADER_SIZE   14
+#define ADS1115_FRAME_MAX_CHANNELS  16
+
+#define ADS1115_FRAME_SEQUENCE      0x01
+#define ADS1115_FRAME_CRC           0x02
+
+// Sample bytes per packet: the sender's buffer, and the largest packet the
+// decoder accepts. Keep the decoder's at least as big as the sender's.
+#ifndef ADS1115_FRAME_BUFFER_SIZE
+#if defined(__AVR__)
+#define ADS1115_FRAME_BUFFER_SIZE   96
+#else
+#define ADS1115_FRAME_BUFFER_SIZE   1024
+#endif
+#endif
+
+#define ADS1115_FRAME_PACKET_SIZE   (ADS1115_FRAME_HEADER_SIZE + 2 + \
+                                     ADS1115_FRAME_BUFFER_SIZE + 2)
+
+/** Byte sink for the sender: a UART, a socket ...
+ * @return Bytes accepted; anything short of len counts as an error
+ */
+typedef size_t (*ADS1115FrameSink)(void *context, const uint8_t *data,
+                                   size_t len);
+
+/** Packs raw samples into packets as they are acquired.
+ * Samples go straight into the packet buffer; a packet is written with a
+ * single sink call once it holds the requested number of frames. With
+ * four channels and 8 frames per packet this is about 10 bytes per frame,
+ * a third of the same data printed as decimal text, and no float
+ * formatting.
+ */
+class ADS1115FrameSender {
+    public:
+        ADS1115FrameSender(ADS1115FrameSink sink, void *context);
+#if defined(ARDUINO)
+        ADS1115FrameSender(Print &out);
+#endif
+
+        bool begin(uint16_t channelMask, uint8_t framesPerPacket,
+                   uint8_t flags = ADS1115_FRAME_SEQUENCE | ADS1115_FRAME_CRC);
+        bool append(const int16_t *frame, uint32_t timestampUs);
+        bool appendScan(ADS1115 &adc, const ADS1115ScanChannel *channels,
+                        uint32_t timestampUs);
+        bool flush();
+
+        uint8_t getChannelCount() const { return channelCount; }
+        uint32_t getPacketCount() const { return packets; }
+        uint32_t getErrors() const { return errors; }
+
+    private:
+        ADS1115FrameSink sink;
+        void    *context;
+        uint16_t channelMask;
+        uint8_t  channelCount;
+        uint8_t  flags;
+        uint8_t  framesPerPacket;
+        uint8_t  frames;
+        uint16_t used;          // bytes in buffer, header included
+        uint16_t sequence;
+        uint32_t firstUs;
+        uint32_t lastUs;
+        uint32_t packets;
+        uint32_t errors;
+        uint8_t  buffer[ADS1115_FRAME_PACKET_SIZE];
+};
+
+/** Incremental packet decoder for the receiving side.
+ * Bytes are pushed as they arrive, in any split; push() reports each
+ * complete packet, whose contents stay available until the next push().
+ * Noise, truncated packets and CRC failures are skipped by searching for
+ * the next sync, and forward gaps in the sequence numbers are counted as
+ * lost packets. A sequence number that goes backwards (the sender was
+ * restarted, or a packet came twice or out of order) is followed as a
+ * resync instead of being read as a 16-bit wrap of lost packets. Plain C++
+ * with no system dependencies.
+ */
+class ADS1115FrameDecoder {
+    public:
+        ADS1115FrameDecoder();
+
+        void reset();
+        bool push(uint8_t byte);
+        size_t feed(const uint8_t *data, size_t len, bool &ready);
+
+        uint16_t getChannelMask() const;
+        uint8_t getChannelCount() const { return channelCount; }
+        uint8_t getFrameCount() const { return buffer[3]; }
+        uint32_t getTimestamp() const;
+        uint32_t getFrameTimestamp(uint8_t frame) const;
+        bool hasSequence() const;
+        uint16_t getSequence() const;
+        int16_t getSample(uint8_t frame, uint8_t slot) const;
+
+        uint32_t getPackets() const { return packets; }
+        uint32_t getCrcErrors() const { return crcErrors; }
+        uint32_t getSkippedBytes() const { return skipped; }
+        uint32_t getLostPackets() const { return lost; }
+        uint32_t getResyncs() const { return resyncs; }
+
+    private:
+        void drop();
+
+        uint16_t have;
+        uint16_t headerSize;
+        uint8_t  channelCount;
+        bool     complete;
+        bool     synced;        // a sequence number has been seen
+        uint16_t nextSequence;
+        uint32_t packets;
+        uint32_t crcErrors;
+        uint32_t skipped;
+        uint32_t lost;
+        uint32_t resyncs;
+        uint8_t  buffer[ADS1115_FRAME_PACKET_SIZE];
+};
+
+#endif /* _ADS1115FRAME_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,125 @@
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+#include "ADS1115.h"
+#include "ADS1115GpioEdge.h"
+
+#define ADS1115_GPIO_EVENT_BATCH    16
+
+/** Edge source on one GPIO line.
+ * @param chipPath GPIO character device, e.g. "/dev/gpiochip0"
+ * @param line Line offset on that chip wired to ALERT/RDY
+ */
+ADS1115GpioEdge::ADS1115GpioEdge(const char *chipPath, uint32_t line)
+{
+    snprintf(this->chipPath, sizeof(this->chipPath), "%s", chipPath);
+    lineOffset = line;
+    fd = -1;
+    lastTimestampNs = 0;
+    coalesced = 0;
+}
+
+ADS1115GpioEdge::~ADS1115GpioEdge()
+{
+    end();
+}
+
+/** Request the line as an input with pull-up and falling-edge events.
+ * @return True on success
+ */
+bool ADS1115GpioEdge::begin()
+{
+    struct gpio_v2_line_request req;
+    int chip;
+
+    if (fd >= 0) {
+        return true;
+    }
+    chip = open(chipPath, O_RDWR | O_CLOEXEC);
+    if (chip < 0) {
+        return false;
+    }
+    memset(&req, 0, sizeof(req));
+    req.offsets[0] = lineOffset;
+    req.num_lines = 1;
+    req.event_buffer_size = ADS1115_GPIO_EVENT_BATCH * 4;
+    req.config.flags = GPIO_V2_LINE_FLAG_INPUT |
+                       GPIO_V2_LINE_FLAG_EDGE_FALLING |
+                       GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+    snprintf(req.consumer, sizeof(req.consumer), "ads1115-rdy");
+    if (ioctl(chip, GPIO_V2_GET_LINE_IOCTL, &req) == 0) {
+        fd = req.fd;
+    }
+    close(chip);
+    return fd >= 0;
+}
+
+void ADS1115GpioEdge::end()
+{
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+/** Block until at least one falling edge arrives or the timeout expires.
+ * @param timeoutMs Timeout in ms, -1 to wait forever
+ * @return Number of edges consumed, 0 on timeout, -1 on error
+ */
+int ADS1115GpioEdge::wait(int timeoutMs)
+{
+    struct gpio_v2_line_event events[ADS1115_GPIO_EVENT_BATCH];
+    struct pollfd pfd;
+    ssize_t len;
+    int count;
+
+    if (fd < 0) {
+        return -1;
+    }
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    count = poll(&pfd, 1, timeoutMs);
+    if (count <= 0) {
+        return (count < 0 && errno != EINTR) ? -1 : 0;
+    }
+    len = read(fd, events, sizeof(events));
+    if (len < (ssize_t)sizeof(events[0])) {
+        return len < 0 ? -1 : 0;
+    }
+    count = (int)(len / sizeof(events[0]));
+    lastTimestampNs = events[count - 1].timestamp_ns;
+    return count;
+}
+
+/** Wait for edges and read the newest conversion.
+ * If the thread fell behind and several edges were queued, only the latest
+ * result is still in the device; the older ones are counted by
+ * getCoalescedEdges().
+ * @param adc Device in ALERT/RDY acquisition mode
+ * @param timeoutMs Timeout in ms, -1 to wait forever
+ * @return Number of edges consumed, 0 on timeout, -1 on error
+ * @see ADS1115::beginReadyAcquisition()
+ */
+int ADS1115GpioEdge::pump(ADS1115 &adc, int timeoutMs)
+{
+    int count = wait(timeoutMs);
+
+    if (count > 0) {
+        coalesced += count - 1;
+        adc.onConversionReady();
+    }
+    return count;
+}
+
+#endif /* __linux__ && !ARDUINO */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,40 @@
+#ifndef _ADS1115GPIOEDGE_H_
+#define _ADS1115GPIOEDGE_H_
+
+#include <inttypes.h>
+
+class ADS1115;
+
+/** ALERT/RDY edge source for Linux hosts.
+ * Requests one line of a GPIO character device (/dev/gpiochipN) with
+ * falling-edge detection and hands each edge to ADS1115::onConversionReady()
+ * from the thread that calls pump(). Run pump() on a dedicated thread and
+ * drain the ring elsewhere.
+ */
+class ADS1115GpioEdge {
+    public:
+        ADS1115GpioEdge(const char *chipPath, uint32_t line);
+        ~ADS1115GpioEdge();
+
+        bool begin();
+        void end();
+
+        int wait(int timeoutMs);
+        int pump(ADS1115 &adc, int timeoutMs);
+        uint64_t getLastTimestamp() const { return lastTimestampNs; }
+        uint32_t getCoalescedEdges() const { return coalesced; }
+
+    private:
+        ADS1115GpioEdge(const ADS1115GpioEdge &);
+        ADS1115GpioEdge &operator=(const ADS1115GpioEdge &);
+
+        char     chipPath[32];
+        uint32_t lineOffset;
+        int      fd;
+        uint64_t lastTimestampNs;
+        uint32_t coalesced;
+};
+
+#endif /* _ADS1115GPIOEDGE_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
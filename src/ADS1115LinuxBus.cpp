@@ -0,0 +1,159 @@
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "ADS1115Bus.h"
+#include "ADS1115LinuxBus.h"
+
+/** Bus on an explicit device node.
+ * @param path Device node, e.g. "/dev/i2c-1"
+ */
+ADS1115LinuxBus::ADS1115LinuxBus(const char *path)
+{
+    snprintf(devPath, sizeof(devPath), "%s", path);
+    fd = -1;
+    ioctlHook = 0;
+    ioctlCount = 0;
+}
+
+/** Bus on /dev/i2c-<busNumber>.
+ * @param busNumber Adapter number
+ */
+ADS1115LinuxBus::ADS1115LinuxBus(uint8_t busNumber)
+{
+    snprintf(devPath, sizeof(devPath), "/dev/i2c-%u", busNumber);
+    fd = -1;
+    ioctlHook = 0;
+    ioctlCount = 0;
+}
+
+ADS1115LinuxBus::~ADS1115LinuxBus()
+{
+    end();
+}
+
+/** Open the adapter. Safe to call once per attached device; only the first
+ * call opens the node.
+ */
+void ADS1115LinuxBus::begin()
+{
+    if (fd < 0) {
+        fd = open(devPath, O_RDWR | O_CLOEXEC);
+    }
+}
+
+void ADS1115LinuxBus::end()
+{
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+/** Run messages as one combined transaction: repeated starts between them
+ * and a single stop at the end, in one I2C_RDWR call.
+ * @param msgs Messages; addresses may differ
+ * @param count Number of messages (at most I2C_RDWR_IOCTL_MAX_MSGS)
+ * @return ADS1115_BUS_OK, ADS1115_BUS_NACK_ADDR or ADS1115_BUS_ERROR;
+ *         the kernel fails the whole call if any message fails
+ */
+uint8_t ADS1115LinuxBus::transfer(struct i2c_msg *msgs, uint8_t count)
+{
+    struct i2c_rdwr_ioctl_data xfer;
+    int result;
+
+    if (fd < 0) {
+        return ADS1115_BUS_ERROR;
+    }
+    xfer.msgs  = msgs;
+    xfer.nmsgs = count;
+    ioctlCount++;
+    result = ioctlHook ? ioctlHook(fd, I2C_RDWR, &xfer)
+                       : ioctl(fd, I2C_RDWR, &xfer);
+    if (result < 0) {
+        return (errno == ENXIO || errno == EREMOTEIO) ? ADS1115_BUS_NACK_ADDR
+                                                      : ADS1115_BUS_ERROR;
+    }
+    return ADS1115_BUS_OK;
+}
+
+/** Route every transfer through hook instead of ioctl(). The hook sees the
+ * real descriptor, so the bus still has to be opened (any node that opens,
+ * such as /dev/null, will do).
+ * @param hook Replacement, or 0 for ioctl()
+ */
+void ADS1115LinuxBus::setIoctl(ADS1115LinuxIoctl hook)
+{
+    ioctlHook = hook;
+}
+
+uint8_t ADS1115LinuxBus::write(uint8_t addr, const uint8_t *data, uint8_t len)
+{
+    struct i2c_msg msg;
+
+    msg.addr  = addr;
+    msg.flags = 0;
+    msg.len   = len;
+    msg.buf   = (uint8_t *)data;
+    return transfer(&msg, 1);
+}
+
+uint8_t ADS1115LinuxBus::read(uint8_t addr, uint8_t *data, uint8_t len)
+{
+    struct i2c_msg msg;
+
+    msg.addr  = addr;
+    msg.flags = I2C_M_RD;
+    msg.len   = len;
+    msg.buf   = data;
+    return transfer(&msg, 1) == ADS1115_BUS_OK ? len : 0;
+}
+
+/** Pointer write and register read in a single I2C_RDWR call, so the kernel
+ * joins the two messages with a repeated start.
+ */
+uint8_t ADS1115LinuxBus::writeRead(uint8_t addr, const uint8_t *wdata,
+                                   uint8_t wlen, uint8_t *rdata, uint8_t rlen)
+{
+    struct i2c_msg msgs[2];
+
+    msgs[0].addr  = addr;
+    msgs[0].flags = 0;
+    msgs[0].len   = wlen;
+    msgs[0].buf   = (uint8_t *)wdata;
+    msgs[1].addr  = addr;
+    msgs[1].flags = I2C_M_RD;
+    msgs[1].len   = rlen;
+    msgs[1].buf   = rdata;
+    return transfer(msgs, 2) == ADS1115_BUS_OK ? rlen : 0;
+}
+
+/** Microseconds on CLOCK_MONOTONIC, truncated to 32 bits like Arduino's.
+ */
+uint32_t ADS1115LinuxBus::micros()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+
+void ADS1115LinuxBus::sleepMicros(uint32_t us)
+{
+    struct timespec ts;
+    ts.tv_sec  = us / 1000000u;
+    ts.tv_nsec = (long)(us % 1000000u) * 1000;
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+    }
+}
+
+#endif /* __linux__ && !ARDUINO */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
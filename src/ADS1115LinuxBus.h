@@ -0,0 +1,53 @@
+#ifndef _ADS1115LINUXBUS_H_
+#define _ADS1115LINUXBUS_H_
+
+#include <inttypes.h>
+
+struct i2c_msg;
+
+/** ioctl() stand-in, e.g. a fake i2c-dev for tests.
+ */
+typedef int (*ADS1115LinuxIoctl)(int fd, unsigned long request, void *arg);
+
+/** Linux i2c-dev transport.
+ * Talks to /dev/i2c-N with I2C_RDWR ioctls, so the slave address travels
+ * with every message and one descriptor serves all devices on the bus.
+ * Several messages, even to different devices, can go out in one call
+ * through transfer() (see ADS1115Batch).
+ */
+class ADS1115LinuxBus {
+    public:
+        ADS1115LinuxBus(const char *path);
+        ADS1115LinuxBus(uint8_t busNumber);
+        ~ADS1115LinuxBus();
+
+        void begin();
+        void end();
+        bool isOpen() const { return fd >= 0; }
+
+        uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len);
+        uint8_t read(uint8_t addr, uint8_t *data, uint8_t len);
+        uint8_t writeRead(uint8_t addr, const uint8_t *wdata, uint8_t wlen,
+                          uint8_t *rdata, uint8_t rlen);
+
+        uint8_t transfer(struct i2c_msg *msgs, uint8_t count);
+        void setIoctl(ADS1115LinuxIoctl hook);
+        uint32_t getIoctlCount() const { return ioctlCount; }
+        void resetIoctlCount() { ioctlCount = 0; }
+
+        uint32_t micros();
+        void sleepMicros(uint32_t us);
+
+    private:
+        ADS1115LinuxBus(const ADS1115LinuxBus &);
+        ADS1115LinuxBus &operator=(const ADS1115LinuxBus &);
+
+        char devPath[32];
+        int  fd;
+        ADS1115LinuxIoctl ioctlHook;
+        uint32_t ioctlCount;
+};
+
+#endif /* _ADS1115LINUXBUS_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,184 @@
+#if defined(ARDUINO)
+#include "Arduino.h"
+#else
+#include <stdio.h>
+#endif
+
+#include "ADS1115Crc.h"
+#include "ADS1115Log.h"
+
+static const uint8_t logMagic[4] = { 'A', 'D', 'L', 'B' };
+
+#if defined(ARDUINO)
+static size_t printSink(void *out, const uint8_t *data, size_t len)
+{
+    return ((Print *)out)->write(data, len);
+}
+
+/** Writer emitting blocks to a Print (Serial, an SD File ...).
+ */
+ADS1115LogWriter::ADS1115LogWriter(Print &out)
+{
+    sink = printSink;
+    context = &out;
+    channels = 0;
+    channelCount = 0;
+    blocks = 0;
+    bytes = 0;
+    errors = 0;
+}
+#else
+/** Sink writing to a stdio FILE, passed as the context.
+ */
+size_t ADS1115LogWriter::fileSink(void *file, const uint8_t *data, size_t len)
+{
+    return fwrite(data, 1, len, (FILE *)file);
+}
+#endif
+
+/** Writer emitting blocks to a sink.
+ * @param sink Byte sink
+ * @param context Passed to every sink call
+ */
+ADS1115LogWriter::ADS1115LogWriter(ADS1115LogSink sink, void *context)
+{
+    this->sink = sink;
+    this->context = context;
+    channels = 0;
+    channelCount = 0;
+    blocks = 0;
+    bytes = 0;
+    errors = 0;
+}
+
+/** Start a new run of blocks for a channel set.
+ * Pending frames of an earlier run are flushed first.
+ * @param channels Descriptors, kept by reference and copied into every block
+ * @param count Number of channels (1..ADS1115_LOG_MAX_CHANNELS)
+ * @return False if count is out of range
+ */
+bool ADS1115LogWriter::begin(const ADS1115LogChannel *channels, uint8_t count)
+{
+    if (count == 0 || count > ADS1115_LOG_MAX_CHANNELS ||
+        count * ADS1115_LOG_MAX_VARINT > ADS1115_LOG_BUFFER_SIZE) {
+        return false;
+    }
+    if (this->channels) {
+        flush();
+    }
+    this->channels = channels;
+    channelCount = count;
+    frames = 0;
+    used = 0;
+    lastUs = 0;
+    lastRawUs = 0;
+    return true;
+}
+
+/** Add one frame (one sample per channel).
+ * Emits a block first if the frame might not fit.
+ * @param frame channelCount raw samples, in descriptor order
+ * @param timestampUs Sample time on a micros()-style clock; wraps are
+ *        tracked, so frames must come at least once per wrap (71 min)
+ * @return False if begin() was not called or the sink failed
+ */
+bool ADS1115LogWriter::append(const int16_t *frame, uint32_t timestampUs)
+{
+    bool ok = true;
+
+    if (!channels) {
+        return false;
+    }
+    if (used + channelCount * ADS1115_LOG_MAX_VARINT >
+            ADS1115_LOG_BUFFER_SIZE || frames == 0xFFFF) {
+        ok = flush();
+    }
+
+    lastUs += (uint32_t)(timestampUs - lastRawUs);
+    lastRawUs = timestampUs;
+    if (frames == 0) {
+        firstUs = lastUs;
+        for (uint8_t c = 0; c < channelCount; c++) {
+            previous[c] = 0;
+        }
+    }
+
+    for (uint8_t c = 0; c < channelCount; c++) {
+        int32_t delta = (int32_t)frame[c] - previous[c];
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+        previous[c] = frame[c];
+        while (zigzag >= 0x80) {
+            buffer[used++] = (uint8_t)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        buffer[used++] = (uint8_t)zigzag;
+    }
+    frames++;
+    return ok;
+}
+
+bool ADS1115LogWriter::emit(const uint8_t *data, size_t len, uint16_t &crc)
+{
+    crc = ADS1115Crc16(data, len, crc);
+    bytes += len;
+    return sink(context, data, len) == len;
+}
+
+/** Emit the pending frames as a block.
+ * @return False if the sink failed (the frames are dropped either way)
+ */
+bool ADS1115LogWriter::flush()
+{
+    uint8_t header[ADS1115_LOG_HEADER_SIZE];
+    uint16_t crc = ADS1115_CRC16_INIT;
+    bool ok = true;
+
+    if (!channels || frames == 0) {
+        return true;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        header[i] = logMagic[i];
+    }
+    header[4] = ADS1115_LOG_VERSION;
+    header[5] = channelCount;
+    header[6] = frames & 0xFF;
+    header[7] = frames >> 8;
+    header[8] = used & 0xFF;
+    header[9] = used >> 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        header[10 + i] = (uint8_t)(firstUs >> (8 * i));
+        header[18 + i] = (uint8_t)(lastUs >> (8 * i));
+    }
+    crc = ADS1115Crc16(header, 26);
+    header[26] = crc & 0xFF;
+    header[27] = crc >> 8;
+    crc = ADS1115_CRC16_INIT;
+    ok = emit(header, sizeof(header), crc);
+
+    for (uint8_t c = 0; c < channelCount; c++) {
+        uint8_t desc[ADS1115_LOG_CHANNEL_SIZE];
+        desc[0] = channels[c].address;
+        desc[1] = channels[c].mux;
+        desc[2] = channels[c].pga;
+        desc[3] = channels[c].rate;
+        desc[4] = channels[c].calibrationId & 0xFF;
+        desc[5] = channels[c].calibrationId >> 8;
+        ok = emit(desc, sizeof(desc), crc) && ok;
+    }
+    ok = emit(buffer, used, crc) && ok;
+
+    header[0] = crc & 0xFF;
+    header[1] = crc >> 8;
+    ok = emit(header, 2, crc) && ok;
+
+    frames = 0;
+    used = 0;
+    blocks++;
+    if (!ok) {
+        errors++;
+    }
+    return ok;
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
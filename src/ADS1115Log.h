@@ -0,0 +1,111 @@
+#ifndef _ADS1115LOG_H_
+#define _ADS1115LOG_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#if defined(ARDUINO)
+class Print;
+#endif
+
+// -----------------------------------------------------------------------------
+// Block log format. A log is a plain sequence of self-contained blocks, so
+// files can be appended to, concatenated and cut at block boundaries.
+// All fields are little-endian.
+//
+//   offset  size  field
+//        0     4  magic "ADLB"
+//        4     1  format version (ADS1115_LOG_VERSION)
+//        5     1  channel count C (1..ADS1115_LOG_MAX_CHANNELS)
+//        6     2  frame count F (one sample per channel per frame)
+//        8     2  payload length P
+//       10     8  timestamp of the first frame, us
+//       18     8  timestamp of the last frame, us
+//       26     2  CRC-16 (ADS1115Crc16) of bytes 0..25
+//       28   6*C  channel descriptors: address, mux, pga, rate,
+//                 calibration id (2)
+//   28+6C      P  payload: F frames of C samples, each the zig-zag varint
+//                 of its difference to the previous sample of the same
+//                 channel (the first frame is relative to 0)
+//   28+6C+P    2  CRC-16 (ADS1115Crc16) of everything before it
+//
+// Frames inside a block are taken as evenly spaced between the two
+// timestamps. The header CRC lets a reader index blocks it trusts without
+// reading their payloads.
+// -----------------------------------------------------------------------------
+
+#define ADS1115_LOG_VERSION         2
+#define ADS1115_LOG_HEADER_SIZE     28
+#define ADS1115_LOG_CHANNEL_SIZE    6
+#define ADS1115_LOG_MAX_CHANNELS    16
+#define ADS1115_LOG_MAX_VARINT      3   // zig-zag of a 17-bit difference
+
+// Payload buffer of the writer: the RAM bound, and the largest block payload
+#ifndef ADS1115_LOG_BUFFER_SIZE
+#if defined(__AVR__)
+#define ADS1115_LOG_BUFFER_SIZE     128
+#else
+#define ADS1115_LOG_BUFFER_SIZE     4096
+#endif
+#endif
+
+/** What one logged channel is.
+ */
+struct ADS1115LogChannel {
+    uint8_t  address;
+    uint8_t  mux;
+    uint8_t  pga;
+    uint8_t  rate;
+    uint16_t calibrationId;     // application-defined, 0 = none
+};
+
+/** Byte sink for the writer: a file, a Print, a socket ...
+ * @return Bytes accepted; anything short of len counts as an error
+ */
+typedef size_t (*ADS1115LogSink)(void *context, const uint8_t *data,
+                                 size_t len);
+
+/** Streaming log writer with bounded RAM.
+ * Samples are delta/zig-zag/varint coded into a fixed payload buffer as
+ * they arrive; a full buffer is emitted as one block, header first. Memory
+ * is the buffer plus one int16_t per channel, whatever the log length.
+ */
+class ADS1115LogWriter {
+    public:
+        ADS1115LogWriter(ADS1115LogSink sink, void *context);
+#if defined(ARDUINO)
+        ADS1115LogWriter(Print &out);
+#else
+        static size_t fileSink(void *file, const uint8_t *data, size_t len);
+#endif
+
+        bool begin(const ADS1115LogChannel *channels, uint8_t count);
+        bool append(const int16_t *frame, uint32_t timestampUs);
+        bool flush();
+
+        uint32_t getBlockCount() const { return blocks; }
+        uint32_t getByteCount() const { return bytes; }
+        uint32_t getErrors() const { return errors; }
+
+    private:
+        bool emit(const uint8_t *data, size_t len, uint16_t &crc);
+
+        ADS1115LogSink sink;
+        void    *context;
+        const ADS1115LogChannel *channels;
+        uint8_t  channelCount;
+        uint16_t frames;
+        uint16_t used;
+        uint64_t firstUs;
+        uint64_t lastUs;
+        uint32_t lastRawUs;
+        int16_t  previous[ADS1115_LOG_MAX_CHANNELS];
+        uint8_t  buffer[ADS1115_LOG_BUFFER_SIZE];
+        uint32_t blocks;
+        uint32_t bytes;
+        uint32_t errors;
+};
+
+#endif /* _ADS1115LOG_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
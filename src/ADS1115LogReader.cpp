@@ -0,0 +1,278 @@
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+
+#include "ADS1115Crc.h"
+#include "ADS1115LogReader.h"
+
+static uint16_t getLE16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint64_t getLE64(const uint8_t *p)
+{
+    uint64_t value = 0;
+    for (int8_t i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+ADS1115LogReader::ADS1115LogReader()
+{
+    data = 0;
+    size = 0;
+    skipped = 0;
+}
+
+ADS1115LogReader::~ADS1115LogReader()
+{
+    close();
+}
+
+void ADS1115LogReader::close()
+{
+    if (data) {
+        munmap((void *)data, size);
+        data = 0;
+    }
+    size = 0;
+    skipped = 0;
+    index.clear();
+}
+
+/** Intact block header at offset?
+ * @param length Whole block length, if so
+ */
+bool ADS1115LogReader::validHeader(uint64_t offset, uint64_t &length) const
+{
+    const uint8_t *p = data + offset;
+
+    if (size - offset < ADS1115_LOG_HEADER_SIZE ||
+        p[0] != 'A' || p[1] != 'D' || p[2] != 'L' || p[3] != 'B' ||
+        p[4] != ADS1115_LOG_VERSION || p[5] == 0 ||
+        p[5] > ADS1115_LOG_MAX_CHANNELS || getLE16(p + 6) == 0 ||
+        ADS1115Crc16(p, 26) != getLE16(p + 26)) {
+        return false;
+    }
+    length = ADS1115_LOG_HEADER_SIZE + p[5] * ADS1115_LOG_CHANNEL_SIZE +
+             getLE16(p + 8) + 2;
+    return length <= size - offset;
+}
+
+/** Map a log file and index its blocks.
+ * The whole file is mapped at once, so on 32-bit hosts it must fit in the
+ * address space; larger files are refused rather than truncated.
+ * @return False if the file cannot be opened or mapped, or is too large
+ */
+bool ADS1115LogReader::open(const char *path)
+{
+    struct stat st;
+    uint64_t offset = 0, samples = 0;
+    int fd;
+    void *map;
+
+    close();
+    fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &st) < 0 || st.st_size <= 0 ||
+        (uint64_t)st.st_size > SIZE_MAX) {
+        ::close(fd);
+        return false;
+    }
+    map = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    data = (const uint8_t *)map;
+    size = st.st_size;
+    madvise(map, size, MADV_RANDOM);
+
+    while (offset < size) {
+        uint64_t length;
+        if (!validHeader(offset, length)) {
+            // resynchronise on the next possible magic
+            const void *next = memchr(data + offset + 1, 'A',
+                                      size - offset - 1);
+            uint64_t to = next ? (const uint8_t *)next - data : size;
+            skipped += to - offset;
+            offset = to;
+            continue;
+        }
+        const uint8_t *p = data + offset;
+        ADS1115LogBlock block;
+        block.offset = offset;
+        block.channels = p[5];
+        block.frames = getLE16(p + 6);
+        block.firstUs = getLE64(p + 10);
+        block.lastUs = getLE64(p + 18);
+        block.sampleIndex = samples;
+        index.push_back(block);
+        samples += (uint64_t)block.frames * block.channels;
+        offset += length;
+    }
+    return true;
+}
+
+const ADS1115LogBlock &ADS1115LogReader::getBlock(size_t block) const
+{
+    return index[block];
+}
+
+/** Descriptor of one channel of a block.
+ * @return False if block or channel is out of range
+ */
+bool ADS1115LogReader::getChannel(size_t block, uint8_t channel,
+                                  ADS1115LogChannel &info) const
+{
+    if (block >= index.size() || channel >= index[block].channels) {
+        return false;
+    }
+    const uint8_t *p = data + index[block].offset + ADS1115_LOG_HEADER_SIZE +
+                       channel * ADS1115_LOG_CHANNEL_SIZE;
+    info.address = p[0];
+    info.mux = p[1];
+    info.pga = p[2];
+    info.rate = p[3];
+    info.calibrationId = getLE16(p + 4);
+    return true;
+}
+
+/** First block whose last frame is at or after timestampUs.
+ * Blocks are taken to be in time order, as the writer emits them.
+ * @return Block index, getBlockCount() if every block is older
+ */
+size_t ADS1115LogReader::findBlock(uint64_t timestampUs) const
+{
+    size_t low = 0, high = index.size();
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (index[mid].lastUs < timestampUs) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/** Samples held by a run of blocks (the size decodeBlocks() fills).
+ */
+uint64_t ADS1115LogReader::getSampleCount(size_t first, size_t count) const
+{
+    if (first >= index.size() || count == 0) {
+        return 0;
+    }
+    if (count > index.size() - first) {
+        count = index.size() - first;
+    }
+    const ADS1115LogBlock &last = index[first + count - 1];
+    return last.sampleIndex + (uint64_t)last.frames * last.channels -
+           index[first].sampleIndex;
+}
+
+/** Decode one block after checking its CRC.
+ * @param out frames * channels samples, frame by frame
+ * @return False if the block is out of range or damaged
+ */
+bool ADS1115LogReader::decodeBlock(size_t block, int16_t *out) const
+{
+    if (block >= index.size()) {
+        return false;
+    }
+    const ADS1115LogBlock &info = index[block];
+    const uint8_t *p = data + info.offset;
+    uint16_t payload = getLE16(p + 8);
+    size_t head = ADS1115_LOG_HEADER_SIZE +
+                  info.channels * ADS1115_LOG_CHANNEL_SIZE;
+    const uint8_t *in = p + head;
+    const uint8_t *end = in + payload;
+    int16_t previous[ADS1115_LOG_MAX_CHANNELS] = { 0 };
+
+    if (ADS1115Crc16(p, head + payload) != getLE16(end)) {
+        return false;
+    }
+    for (uint16_t f = 0; f < info.frames; f++) {
+        for (uint8_t c = 0; c < info.channels; c++) {
+            uint32_t zigzag = 0;
+            uint8_t shift = 0;
+            do {
+                if (in == end || shift > 14) {
+                    return false;
+                }
+                zigzag |= (uint32_t)(*in & 0x7F) << shift;
+                shift += 7;
+            } while (*in++ & 0x80);
+            int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            previous[c] = (int16_t)(previous[c] + delta);
+            *out++ = previous[c];
+        }
+    }
+    return in == end;
+}
+
+/** Decode a run of blocks into one buffer, split over several threads.
+ * @param out getSampleCount(first, count) samples
+ * @param threads Worker threads; 0 uses one per core
+ * @return Number of blocks decoded (damaged blocks are left as zeros)
+ */
+size_t ADS1115LogReader::decodeBlocks(size_t first, size_t count,
+                                      int16_t *out, unsigned threads) const
+{
+    std::vector<std::thread> workers;
+    std::vector<size_t> decoded;
+
+    if (first >= index.size() || count == 0) {
+        return 0;
+    }
+    if (count > index.size() - first) {
+        count = index.size() - first;
+    }
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0 || threads > count) {
+        threads = threads == 0 ? 1 : count;
+    }
+
+    decoded.assign(threads, 0);
+    for (unsigned t = 0; t < threads; t++) {
+        size_t begin = first + count * t / threads;
+        size_t end = first + count * (t + 1) / threads;
+        size_t *done = &decoded[t];
+        workers.push_back(std::thread([this, begin, end, first, out, done]() {
+            for (size_t b = begin; b < end; b++) {
+                const ADS1115LogBlock &info = index[b];
+                int16_t *dest = out + (info.sampleIndex -
+                                       index[first].sampleIndex);
+                if (decodeBlock(b, dest)) {
+                    (*done)++;
+                } else {
+                    memset(dest, 0, (size_t)info.frames * info.channels *
+                                    sizeof(int16_t));
+                }
+            }
+        }));
+    }
+    size_t total = 0;
+    for (unsigned t = 0; t < threads; t++) {
+        workers[t].join();
+        total += decoded[t];
+    }
+    return total;
+}
+
+#endif /* __linux__ && !ARDUINO */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,63 @@
+#ifndef _ADS1115LOGREADER_H_
+#define _ADS1115LOGREADER_H_
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <vector>
+
+#include "ADS1115Log.h"
+
+/** Location and extent of one block, from its header alone.
+ */
+struct ADS1115LogBlock {
+    uint64_t offset;            // of the block in the file
+    uint64_t firstUs;
+    uint64_t lastUs;
+    uint64_t sampleIndex;       // samples in all earlier blocks
+    uint16_t frames;
+    uint8_t  channels;
+};
+
+/** Memory-mapped reader for ADS1115LogWriter output (Linux hosts).
+ * open() maps the file and indexes it by walking block headers only; a
+ * header whose own CRC fails is treated as damage, and damaged stretches
+ * are skipped by searching for the next block magic. Payloads
+ * are decoded on demand, one block at a time or many in parallel, and
+ * findBlock() bisects the index by time, so a time range in a multi-GB
+ * archive costs the pages of the blocks that cover it.
+ */
+class ADS1115LogReader {
+    public:
+        ADS1115LogReader();
+        ~ADS1115LogReader();
+
+        bool open(const char *path);
+        void close();
+
+        size_t getBlockCount() const { return index.size(); }
+        const ADS1115LogBlock &getBlock(size_t block) const;
+        bool getChannel(size_t block, uint8_t channel,
+                        ADS1115LogChannel &info) const;
+        uint64_t getSkippedBytes() const { return skipped; }
+
+        size_t findBlock(uint64_t timestampUs) const;
+        bool decodeBlock(size_t block, int16_t *out) const;
+        size_t decodeBlocks(size_t first, size_t count, int16_t *out,
+                            unsigned threads = 0) const;
+        uint64_t getSampleCount(size_t first, size_t count) const;
+
+    private:
+        ADS1115LogReader(const ADS1115LogReader &);
+        ADS1115LogReader &operator=(const ADS1115LogReader &);
+
+        bool validHeader(uint64_t offset, uint64_t &length) const;
+
+        const uint8_t *data;
+        uint64_t size;
+        uint64_t skipped;
+        std::vector<ADS1115LogBlock> index;
+};
+
+#endif /* _ADS1115LOGREADER_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
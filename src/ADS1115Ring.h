@@ -0,0 +1,111 @@
+#ifndef _ADS1115RING_H_
+#define _ADS1115RING_H_
+
+#include <inttypes.h>
+
+// Index width: a single byte on AVR so the ISR and the main loop can read it
+// atomically, 16 bits elsewhere.
+#if defined(__AVR__)
+typedef uint8_t ADS1115RingIndex;
+#else
+typedef uint16_t ADS1115RingIndex;
+#endif
+
+/** Single-producer / single-consumer lock-free ring.
+ * The producer (an ISR or edge thread) only writes head and the overrun
+ * counter; the consumer only writes tail. Indices are published with
+ * acquire/release atomics, so no locks or interrupt masking are needed.
+ * Capacity must be a power of two; one slot is kept free to tell full from
+ * empty. Storage is supplied by the caller (see ADS1115StaticRing).
+ */
+template <typename T>
+class ADS1115Ring {
+    public:
+        ADS1115Ring(T *buffer, ADS1115RingIndex capacity)
+            : data(buffer), mask(capacity - 1), head(0), tail(0), overruns(0)
+        {
+        }
+
+        /** Producer side. Drops the item and counts an overrun when full.
+         * @return False if the ring was full
+         */
+        bool push(const T &item)
+        {
+            ADS1115RingIndex h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+            ADS1115RingIndex next = (h + 1) & mask;
+            if (next == __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) {
+                overruns = overruns + 1;
+                return false;
+            }
+            data[h] = item;
+            __atomic_store_n(&head, next, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        /** Consumer side, one item.
+         * @return False if the ring was empty
+         */
+        bool pop(T &item)
+        {
+            return popBatch(&item, 1) == 1;
+        }
+
+        /** Consumer side, up to max items in one go.
+         * @return Number of items copied to out
+         */
+        uint16_t popBatch(T *out, uint16_t max)
+        {
+            ADS1115RingIndex t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+            ADS1115RingIndex h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+            uint16_t count = 0;
+
+            while (t != h && count < max) {
+                out[count++] = data[t];
+                t = (t + 1) & mask;
+            }
+            __atomic_store_n(&tail, t, __ATOMIC_RELEASE);
+            return count;
+        }
+
+        uint16_t available() const
+        {
+            return (__atomic_load_n(&head, __ATOMIC_ACQUIRE) -
+                    __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) & mask;
+        }
+
+        uint16_t capacity() const
+        {
+            return mask;
+        }
+
+        uint32_t getOverruns() const
+        {
+            return overruns;
+        }
+
+    private:
+        T *data;
+        ADS1115RingIndex mask;
+        ADS1115RingIndex head;
+        ADS1115RingIndex tail;
+        volatile uint32_t overruns;     // producer-owned, diagnostic only
+};
+
+/** ADS1115Ring with embedded storage of N (power of two) slots.
+ */
+template <typename T, ADS1115RingIndex N>
+class ADS1115StaticRing : public ADS1115Ring<T> {
+    public:
+        ADS1115StaticRing() : ADS1115Ring<T>(storage, N)
+        {
+        }
+
+    private:
+        static_assert(N >= 2 && (N & (N - 1)) == 0,
+                      "ring capacity must be a power of two");
+        T storage[N];
+};
+
+#endif /* _ADS1115RING_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,308 @@
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <chrono>
+
+#include "ADS1115.h"
+#include "ADS1115Service.h"
+
+ADS1115Service::Worker::Worker()
+    : storage(ADS1115_SERVICE_QUEUE_SIZE),
+      output(storage.data(), ADS1115_SERVICE_QUEUE_SIZE), processed(0)
+{
+}
+
+/** Service with a pool of post-processing threads.
+ * @param workers Pool size; 0 uses one thread per core
+ */
+ADS1115Service::ADS1115Service(uint8_t workers)
+    : busCount(0), processor(0), processorContext(0), running(false),
+      sampling(false), steals(0)
+{
+    if (workers == 0) {
+        unsigned cores = std::thread::hardware_concurrency();
+        workers = cores ? (uint8_t)(cores < 255 ? cores : 255) : 1;
+    }
+    if (workers > ADS1115_SERVICE_MAX_WORKERS) {
+        workers = ADS1115_SERVICE_MAX_WORKERS;
+    }
+    workerCount = workers;
+    for (uint8_t i = 0; i < workerCount; i++) {
+        this->workers[i].reset(new Worker());
+    }
+}
+
+ADS1115Service::~ADS1115Service()
+{
+    stop();
+}
+
+/** Register a bus; its devices are added with add().
+ * @return Bus index, or -1 if the service is full or running
+ */
+int8_t ADS1115Service::addBus()
+{
+    if (running || busCount >= ADS1115_SERVICE_MAX_BUSES) {
+        return -1;
+    }
+    Bus *bus = new Bus();
+    bus->clock = 0;
+    bus->channels = 0;
+    bus->scans = 0;
+    buses[busCount].reset(bus);
+    return (int8_t)busCount++;
+}
+
+/** Add a device and its channel list to a bus.
+ * The device must sit on that bus and must not be touched by anyone else
+ * while the service runs.
+ * @param bus Index returned by addBus()
+ * @param adc Device; rate and comparator settings are taken as configured
+ * @param channels MUX/PGA list, kept by reference
+ * @param count Number of channels
+ * @return False if running, the bus is unknown or its channels are full
+ */
+bool ADS1115Service::add(uint8_t bus, ADS1115 &adc,
+                         const ADS1115ScanChannel *channels, uint8_t count)
+{
+    if (running || bus >= busCount ||
+        buses[bus]->channels + count > ADS1115_SERVICE_MAX_CHANNELS) {
+        return false;
+    }
+    Bus &b = *buses[bus];
+    if (!b.coordinator.add(adc, channels, count)) {
+        return false;
+    }
+    b.counts[b.coordinator.getDeviceCount() - 1] = count;
+    for (uint8_t i = 0; i < count; i++) {
+        b.pga[b.channels++] = channels[i].pga;
+    }
+    if (!b.clock) {
+        b.clock = &adc;
+    }
+    return true;
+}
+
+/** Hook run on every block after scaling to microvolts.
+ * Must be thread-safe: pool threads call it concurrently.
+ */
+void ADS1115Service::setProcessor(ADS1115ServiceProcessor processor,
+                                  void *context)
+{
+    this->processor = processor;
+    processorContext = context;
+}
+
+/** Start one thread per bus and the post-processing pool.
+ * @return False if already running or no bus has devices
+ */
+bool ADS1115Service::start()
+{
+    bool any = false;
+
+    if (running) {
+        return false;
+    }
+    for (uint8_t i = 0; i < busCount; i++) {
+        any = any || buses[i]->channels > 0;
+    }
+    if (!any) {
+        return false;
+    }
+    running = true;
+    sampling = true;
+    for (uint8_t i = 0; i < workerCount; i++) {
+        workers[i]->thread = std::thread(&ADS1115Service::runWorker, this, i);
+    }
+    for (uint8_t i = 0; i < busCount; i++) {
+        if (buses[i]->channels) {
+            buses[i]->thread = std::thread(&ADS1115Service::runBus, this, i);
+        }
+    }
+    return true;
+}
+
+/** Stop sampling, let the pool finish queued scans, and join all threads.
+ * Blocks already published stay readable.
+ */
+void ADS1115Service::stop()
+{
+    if (!running) {
+        return;
+    }
+    sampling = false;
+    for (uint8_t i = 0; i < busCount; i++) {
+        if (buses[i]->thread.joinable()) {
+            buses[i]->thread.join();
+        }
+    }
+    running = false;
+    for (uint8_t i = 0; i < workerCount; i++) {
+        workers[i]->thread.join();
+    }
+}
+
+/** Drain published blocks. Call from one thread only.
+ * @return Number of blocks copied
+ */
+size_t ADS1115Service::read(ADS1115ServiceBlock *blocks, size_t max)
+{
+    size_t got = 0;
+
+    for (uint8_t i = 0; i < workerCount && got < max; i++) {
+        size_t want = max - got;
+        got += workers[i]->output.popBatch(blocks + got,
+                                           want > 0xFFFF ? 0xFFFF : want);
+    }
+    return got;
+}
+
+uint64_t ADS1115Service::getScans(uint8_t bus) const
+{
+    return bus < busCount ? buses[bus]->scans.load() : 0;
+}
+
+uint64_t ADS1115Service::getProcessed() const
+{
+    uint64_t total = 0;
+    for (uint8_t i = 0; i < workerCount; i++) {
+        total += workers[i]->processed;
+    }
+    return total;
+}
+
+/** Blocks dropped because read() did not keep up.
+ */
+uint32_t ADS1115Service::getOverruns() const
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < workerCount; i++) {
+        total += workers[i]->output.getOverruns();
+    }
+    return total;
+}
+
+void ADS1115Service::runBus(uint8_t index)
+{
+    Bus &bus = *buses[index];
+    uint8_t next = index % workerCount;
+    Job job;
+
+    job.bus = index;
+    job.sequence = 0;
+    while (sampling) {
+        job.timestamp = bus.clock->getBus().micros();
+        bus.coordinator.scan(job.raw);
+        job.valid = 0;
+        for (uint8_t d = 0, at = 0; d < bus.coordinator.getDeviceCount();
+             at += bus.counts[d], d++) {
+            job.valid |= (uint32_t)bus.coordinator.getValidMask(d) << at;
+        }
+        bus.scans++;
+        while (!submit(job, next)) {
+            if (!sampling) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        job.sequence++;
+    }
+}
+
+/** Deal a job to the next pool thread with room, round-robin.
+ * @return False if every deque is at ADS1115_SERVICE_MAX_PENDING
+ */
+bool ADS1115Service::submit(Job &job, uint8_t &next)
+{
+    for (uint8_t tries = 0; tries < workerCount; tries++) {
+        Worker &worker = *workers[next];
+        next = (next + 1) % workerCount;
+
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if (worker.jobs.size() < ADS1115_SERVICE_MAX_PENDING) {
+            worker.jobs.push_back(job);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Newest job of our own deque (still warm in cache), else the oldest job
+ * of the first other deque that has one.
+ */
+bool ADS1115Service::take(uint8_t index, Job &job)
+{
+    {
+        Worker &own = *workers[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+    for (uint8_t i = 1; i < workerCount; i++) {
+        Worker &victim = *workers[(index + i) % workerCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ADS1115Service::process(Worker &worker, const Job &job)
+{
+    const Bus &bus = *buses[job.bus];
+    ADS1115ServiceBlock block;
+
+    block.timestamp = job.timestamp;
+    block.sequence = job.sequence;
+    block.bus = job.bus;
+    block.count = bus.channels;
+    block.valid = job.valid;
+    block.flags = 0;
+    for (uint8_t i = 0; i < bus.channels; i++) {
+        if (job.valid & ((uint32_t)1 << i)) {
+            block.value[i] = ADS1115CFG::microVolts(job.raw[i], bus.pga[i]);
+        } else {
+            block.value[i] = 0;
+            block.flags = ADS1115_SERVICE_PARTIAL;
+        }
+    }
+    if (processor) {
+        processor(block, processorContext);
+    }
+    worker.output.push(block);
+    worker.processed++;
+}
+
+void ADS1115Service::runWorker(uint8_t index)
+{
+    Worker &worker = *workers[index];
+    Job job;
+    unsigned idle = 0;
+
+    for (;;) {
+        if (take(index, job)) {
+            process(worker, job);
+            idle = 0;
+            continue;
+        }
+        if (!running) {
+            return;
+        }
+        // Spin briefly, then back off to a short sleep while buses are slow
+        if (++idle < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+#endif
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
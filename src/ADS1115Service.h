@@ -0,0 +1,135 @@
+#ifndef _ADS1115SERVICE_H_
+#define _ADS1115SERVICE_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ADS1115Coordinator.h"
+#include "ADS1115Ring.h"
+
+class ADS1115;
+struct ADS1115ScanChannel;
+
+#define ADS1115_SERVICE_MAX_BUSES       8
+#define ADS1115_SERVICE_MAX_WORKERS     16
+// Four addresses per bus, each with up to a full coordinator channel list
+#define ADS1115_SERVICE_MAX_CHANNELS    (4 * ADS1115_COORDINATOR_MAX_CHANNELS)
+// Output ring slots per worker (power of two)
+#define ADS1115_SERVICE_QUEUE_SIZE      256
+// Scans waiting for post-processing, per worker, before a bus thread backs off
+#define ADS1115_SERVICE_MAX_PENDING     64
+
+#define ADS1115_SERVICE_PARTIAL         0x01 // some conversions failed
+
+/** One scan of one bus after post-processing.
+ * value[] holds microvolts in the order the bus's channel lists were added,
+ * unless the processor replaced them. Channels whose conversion timed out
+ * or failed on the bus have their bit clear in valid and a value of 0.
+ */
+struct ADS1115ServiceBlock {
+    uint32_t timestamp;     // bus clock when the scan started, us
+    uint32_t sequence;      // per bus, consecutive
+    uint32_t valid;         // bit n set = value[n] converted in this scan
+    uint8_t  bus;
+    uint8_t  count;
+    uint8_t  flags;
+    int32_t  value[ADS1115_SERVICE_MAX_CHANNELS];
+};
+
+/** Post-processing hook (filtering, encoding ...), run on a pool thread.
+ */
+typedef void (*ADS1115ServiceProcessor)(ADS1115ServiceBlock &block,
+                                        void *context);
+
+/** Multi-bus acquisition service for Linux hosts.
+ * Every bus gets a thread that owns it and its devices outright and runs an
+ * ADS1115Coordinator scan after scan; sampling never migrates, as a bus
+ * serializes its traffic anyway. Finished scans go to a pool of
+ * post-processing threads, dealt round-robin into per-thread deques; an
+ * idle thread takes the newest job from its own deque and otherwise steals
+ * the oldest from another. Each pool thread publishes results through its
+ * own lock-free ADS1115Ring, which read() drains, so blocks of different
+ * buses may arrive out of order: use sequence to reorder.
+ */
+class ADS1115Service {
+    public:
+        ADS1115Service(uint8_t workers = 0);
+        ~ADS1115Service();
+
+        int8_t addBus();
+        bool add(uint8_t bus, ADS1115 &adc,
+                 const ADS1115ScanChannel *channels, uint8_t count);
+        void setProcessor(ADS1115ServiceProcessor processor, void *context);
+
+        bool start();
+        void stop();
+        bool isRunning() const { return running; }
+
+        size_t read(ADS1115ServiceBlock *blocks, size_t max);
+
+        uint8_t getBusCount() const { return busCount; }
+        uint8_t getWorkerCount() const { return workerCount; }
+        uint64_t getScans(uint8_t bus) const;
+        uint64_t getProcessed() const;
+        uint64_t getSteals() const { return steals; }
+        uint32_t getOverruns() const;
+
+    private:
+        ADS1115Service(const ADS1115Service &);
+        ADS1115Service &operator=(const ADS1115Service &);
+
+        struct Job {
+            uint32_t timestamp;
+            uint32_t sequence;
+            uint32_t valid;
+            uint8_t  bus;
+            int16_t  raw[ADS1115_SERVICE_MAX_CHANNELS];
+        };
+
+        struct Bus {
+            ADS1115Coordinator coordinator;
+            ADS1115 *clock;             // first device, for timestamps
+            uint8_t  channels;
+            uint8_t  pga[ADS1115_SERVICE_MAX_CHANNELS];
+            uint8_t  counts[ADS1115_COORDINATOR_MAX_DEVICES];   // per device
+            std::thread thread;
+            std::atomic<uint64_t> scans;
+        };
+
+        struct Worker {
+            Worker();
+
+            std::mutex lock;            // guards jobs only
+            std::deque<Job> jobs;
+            std::vector<ADS1115ServiceBlock> storage;
+            ADS1115Ring<ADS1115ServiceBlock> output;
+            std::thread thread;
+            std::atomic<uint64_t> processed;
+        };
+
+        void runBus(uint8_t index);
+        void runWorker(uint8_t index);
+        bool submit(Job &job, uint8_t &next);
+        bool take(uint8_t index, Job &job);
+        void process(Worker &worker, const Job &job);
+
+        std::unique_ptr<Bus> buses[ADS1115_SERVICE_MAX_BUSES];
+        std::unique_ptr<Worker> workers[ADS1115_SERVICE_MAX_WORKERS];
+        uint8_t busCount;
+        uint8_t workerCount;
+        ADS1115ServiceProcessor processor;
+        void *processorContext;
+        std::atomic<bool> running;
+        std::atomic<bool> sampling;
+        std::atomic<uint64_t> steals;
+};
+
+#endif /* _ADS1115SERVICE_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
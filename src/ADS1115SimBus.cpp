@@ -0,0 +1,567 @@
+#include "ADS1115.h"
+#include "ADS1115SimBus.h"
+
+#define SIM_NEVER   UINT64_MAX
+
+// AIN pins behind each MUX setting; 4 = GND
+static const uint8_t muxPositive[8] = { 0, 0, 1, 2, 0, 1, 2, 3 };
+static const uint8_t muxNegative[8] = { 1, 3, 3, 3, 4, 4, 4, 4 };
+
+/** Device answering at the given I2C address, in its power-up state.
+ * All pins sit at 0 V and the oscillator is exact.
+ * @param address I2C address
+ * @see ADS1115_DEFAULT_ADDRESS
+ */
+ADS1115SimDevice::ADS1115SimDevice(uint8_t address)
+{
+    devAddr = address;
+    fixedMask = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        fixed[i] = 0;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        pinUv[i] = 0;
+        waveform[i] = 0;
+        waveformContext[i] = 0;
+    }
+    oscPpm = 0;
+    alertHandler = 0;
+    alertContext = 0;
+    clock = 0;
+    alertEdges = 0;
+    alertLevel = true;
+    reset();
+}
+
+/** Restore power-up register values (CONFIG 0x8583, thresholds 0x8000/0x7FFF).
+ * Inputs, oscillator error and the handler are kept; time is not reset.
+ */
+void ADS1115SimDevice::reset()
+{
+    pointer = ADS1115_RA_CONVERSION;
+    regs[ADS1115_RA_CONVERSION] = 0x0000;
+    regs[ADS1115_RA_CONFIG]     = 0x0583;   // OS is derived from busy
+    regs[ADS1115_RA_LO_THRESH]  = 0x8000;
+    regs[ADS1115_RA_HI_THRESH]  = 0x7FFF;
+    convConfig = regs[ADS1115_RA_CONFIG];
+    busy = false;
+    doneAt = SIM_NEVER;
+    pulseEndAt = 0;
+    readyHeld = false;
+    alertActive = false;
+    queueCount = 0;
+    conversions = 0;
+    updatePin();
+}
+
+/** Pin a MUX setting to a fixed result, whatever the PGA and the pins.
+ * @param mux MUX setting
+ * @param counts Raw conversion result
+ * @see ADS1115_MUX_P0_N1
+ */
+void ADS1115SimDevice::setInput(uint8_t mux, int16_t counts)
+{
+    fixed[mux & 0x07] = counts;
+    fixedMask |= 1 << (mux & 0x07);
+}
+
+/** Hold an AIN pin at a constant voltage.
+ * @param pin 0..3
+ * @param microVolts Pin voltage relative to GND
+ */
+void ADS1115SimDevice::setVoltage(uint8_t pin, int32_t microVolts)
+{
+    pinUv[pin & 0x03] = microVolts;
+    waveform[pin & 0x03] = 0;
+}
+
+/** Drive an AIN pin from a waveform, sampled at each conversion's end.
+ * @param pin 0..3
+ * @param waveform Source, 0 to return to the constant voltage
+ * @param context Passed to every waveform call
+ */
+void ADS1115SimDevice::setWaveform(uint8_t pin, ADS1115SimWaveform waveform,
+                                   void *context)
+{
+    this->waveform[pin & 0x03] = waveform;
+    waveformContext[pin & 0x03] = context;
+}
+
+/** Make the oscillator run off nominal; conversions started from now on use it.
+ * @param ppm Error; positive runs fast (shorter conversions)
+ */
+void ADS1115SimDevice::setOscillatorError(int32_t ppm)
+{
+    oscPpm = ppm;
+}
+
+/** Get told about ALERT/RDY edges.
+ * @param handler Called on each level change, 0 for none
+ */
+void ADS1115SimDevice::setAlertHandler(ADS1115SimAlertHandler handler,
+                                       void *context)
+{
+    alertHandler = handler;
+    alertContext = context;
+}
+
+/** Conversion period for the current DR code and oscillator error.
+ */
+uint64_t ADS1115SimDevice::period() const
+{
+    uint8_t rate = (convConfig & ADS1115_CFG_DR_MASK) >> ADS1115_CFG_DR_SHIFT;
+
+    return 1000000000000000ULL /
+           ((uint64_t)ADS1115CFG::dataRate(rate) * (1000000 + oscPpm));
+}
+
+/** Time of the next internal event (conversion end, end of an RDY pulse).
+ * @return Virtual time in ns, UINT64_MAX if nothing is scheduled
+ */
+uint64_t ADS1115SimDevice::nextEvent() const
+{
+    uint64_t next = busy ? doneAt : SIM_NEVER;
+
+    if (pulseEndAt && pulseEndAt < next) {
+        next = pulseEndAt;
+    }
+    return next;
+}
+
+/** Play all events up to a point in time.
+ * @param nowNs Virtual time; earlier values than the last one are ignored
+ */
+void ADS1115SimDevice::update(uint64_t nowNs)
+{
+    for (;;) {
+        uint64_t next = nextEvent();
+        if (next > nowNs) {
+            break;
+        }
+        if (next > clock) {
+            clock = next;
+        }
+        if (pulseEndAt && pulseEndAt == next) {
+            pulseEndAt = 0;
+            updatePin();
+        } else {
+            complete(next);
+        }
+    }
+    if (nowNs > clock) {
+        clock = nowNs;
+    }
+}
+
+void ADS1115SimDevice::start(uint64_t delayNs)
+{
+    convConfig = regs[ADS1115_RA_CONFIG];
+    busy = true;
+    doneAt = clock + delayNs + period();
+    if (readyHeld) {
+        readyHeld = false;
+        updatePin();
+    }
+}
+
+void ADS1115SimDevice::complete(uint64_t at)
+{
+    int16_t value = sample(at);
+
+    regs[ADS1115_RA_CONVERSION] = (uint16_t)value;
+    conversions++;
+    if (regs[ADS1115_RA_CONFIG] & ADS1115_CFG_MODE_BIT) {
+        busy = false;
+        doneAt = SIM_NEVER;
+    } else {
+        convConfig = regs[ADS1115_RA_CONFIG];
+        doneAt = at + period();
+    }
+    compare(value);
+}
+
+int32_t ADS1115SimDevice::pinVoltage(uint8_t pin, uint64_t at) const
+{
+    if (pin > 3) {
+        return 0;
+    }
+    if (waveform[pin]) {
+        return waveform[pin](waveformContext[pin], at);
+    }
+    return pinUv[pin];
+}
+
+/** Result of a conversion of the latched MUX/PGA ending at the given time.
+ */
+int16_t ADS1115SimDevice::sample(uint64_t at) const
+{
+    uint8_t mux = (convConfig & ADS1115_CFG_MUX_MASK) >> ADS1115_CFG_MUX_SHIFT;
+    uint8_t pga = (convConfig & ADS1115_CFG_PGA_MASK) >> ADS1115_CFG_PGA_SHIFT;
+    int64_t fullScaleUv = (int64_t)ADS1115CFG::fullScale(pga) * 1000;
+    int64_t diff, counts;
+
+    if (fixedMask & (1 << mux)) {
+        return fixed[mux];
+    }
+    diff = (int64_t)pinVoltage(muxPositive[mux], at) -
+           pinVoltage(muxNegative[mux], at);
+    counts = diff * 32768;
+    counts = (counts + (counts < 0 ? -fullScaleUv : fullScaleUv) / 2) /
+             fullScaleUv;
+    if (counts > 32767) {
+        return 32767;
+    }
+    if (counts < -32768) {
+        return -32768;
+    }
+    return (int16_t)counts;
+}
+
+/** Run the comparator or the conversion-ready logic on a new result.
+ */
+void ADS1115SimDevice::compare(int16_t value)
+{
+    uint16_t config = regs[ADS1115_RA_CONFIG];
+    uint8_t queue = config & ADS1115_CFG_COMP_QUE_MASK;
+    int16_t hi = (int16_t)regs[ADS1115_RA_HI_THRESH];
+    int16_t lo = (int16_t)regs[ADS1115_RA_LO_THRESH];
+    bool window = (config & ADS1115_CFG_COMP_MODE_BIT) != 0;
+    bool beyond;
+
+    if (queue == 0x03) {
+        return;
+    }
+    if ((regs[ADS1115_RA_HI_THRESH] & 0x8000) &&
+        !(regs[ADS1115_RA_LO_THRESH] & 0x8000)) {
+        if (config & ADS1115_CFG_MODE_BIT) {
+            readyHeld = true;
+        } else {
+            pulseEndAt = clock + ADS1115_SIM_RDY_PULSE_NS;
+        }
+        updatePin();
+        return;
+    }
+
+    beyond = window ? (value > hi || value < lo) : value > hi;
+    if (beyond) {
+        if (queueCount < 4) {
+            queueCount++;
+        }
+        if (queueCount >= (1 << queue)) {
+            alertActive = true;
+        }
+    } else {
+        queueCount = 0;
+        if (!(config & ADS1115_CFG_COMP_LAT_BIT) && (window || value < lo)) {
+            alertActive = false;
+        }
+    }
+    updatePin();
+}
+
+/** Recompute the ALERT/RDY level and report a change.
+ */
+void ADS1115SimDevice::updatePin()
+{
+    uint16_t config = regs[ADS1115_RA_CONFIG];
+    bool active = false, level;
+
+    if ((config & ADS1115_CFG_COMP_QUE_MASK) != 0x03) {
+        if ((regs[ADS1115_RA_HI_THRESH] & 0x8000) &&
+            !(regs[ADS1115_RA_LO_THRESH] & 0x8000)) {
+            active = readyHeld || pulseEndAt != 0;
+        } else {
+            active = alertActive;
+        }
+    }
+    // disabled = high impedance, read as high through the pull-up
+    level = (config & ADS1115_CFG_COMP_POL_BIT) ? active : !active;
+    if (level != alertLevel) {
+        alertLevel = level;
+        alertEdges++;
+        if (alertHandler) {
+            alertHandler(alertContext, level);
+        }
+    }
+}
+
+/** Register contents as the bus would read them (OS derived from state).
+ */
+uint16_t ADS1115SimDevice::getRegister(uint8_t regAddr) const
+{
+    uint16_t value = regs[regAddr & 0x03];
+
+    if ((regAddr & 0x03) == ADS1115_RA_CONFIG && !busy) {
+        value |= ADS1115_CFG_OS_BIT;
+    }
+    return value;
+}
+
+/** Handle a write transaction: pointer byte, then an optional 16-bit value.
+ * @return Wire-style status
+ */
+uint8_t ADS1115SimDevice::write(const uint8_t *data, uint8_t len)
+{
+    if (len != 1 && len != 3) {
+        return ADS1115_BUS_NACK_DATA;
+    }
+    pointer = data[0] & 0x03;
+    if (len == 1) {
+        return ADS1115_BUS_OK;
+    }
+
+    uint16_t value = ((uint16_t)data[1] << 8) | data[2];
+    uint16_t previous = regs[ADS1115_RA_CONFIG];
+    switch (pointer) {
+        case ADS1115_RA_CONVERSION:
+            // read-only
+            break;
+        case ADS1115_RA_CONFIG:
+            regs[ADS1115_RA_CONFIG] = value & ~ADS1115_CFG_OS_BIT;
+            if ((value ^ previous) & (ADS1115_CFG_COMP_MODE_BIT |
+                                      ADS1115_CFG_COMP_QUE_MASK)) {
+                queueCount = 0;
+                alertActive = false;
+            }
+            if (!(value & ADS1115_CFG_MODE_BIT)) {
+                // continuous: any CONFIG write restarts the cycle
+                start((previous & ADS1115_CFG_MODE_BIT) && !busy ?
+                      (uint64_t)ADS1115_WAKEUP_US * 1000 : 0);
+            } else if ((value & ADS1115_CFG_OS_BIT) && !busy) {
+                start((uint64_t)ADS1115_WAKEUP_US * 1000);
+            }
+            // leaving continuous mode: the running conversion finishes,
+            // then the device powers down (complete() sees MODE set)
+            updatePin();
+            break;
+        default:
+            regs[pointer] = value;
+            updatePin();
+            break;
+    }
+    return ADS1115_BUS_OK;
+}
+
+/** Handle a read transaction from the register selected by the pointer.
+ * Reading CONVERSION clears a latched alert.
+ * @return Number of bytes returned
+ */
+uint8_t ADS1115SimDevice::read(uint8_t *data, uint8_t len)
+{
+    uint16_t value = getRegister(pointer);
+
+    for (uint8_t i = 0; i < len; i++) {
+        data[i] = (i & 1) ? (value & 0xFF) : (value >> 8);
+    }
+    if (pointer == ADS1115_RA_CONVERSION && alertActive &&
+        (regs[ADS1115_RA_CONFIG] & ADS1115_CFG_COMP_LAT_BIT)) {
+        alertActive = false;
+        updatePin();
+    }
+    return len;
+}
+
+/** SMBus alert response: claim and clear an active latched alert.
+ * @return True if this device was alerting
+ */
+bool ADS1115SimDevice::alertResponse()
+{
+    if (!alertActive ||
+        !(regs[ADS1115_RA_CONFIG] & ADS1115_CFG_COMP_LAT_BIT)) {
+        return false;
+    }
+    alertActive = false;
+    updatePin();
+    return true;
+}
+
+ADS1115SimBus::ADS1115SimBus()
+{
+    deviceCount = 0;
+    clockHz = ADS1115_SIM_CLOCK_HZ;
+    now = 0;
+    resetCounters();
+}
+
+/** Put a device on the bus; it joins at the bus's current time.
+ * @return False if the bus is full or the address is taken
+ */
+bool ADS1115SimBus::attach(ADS1115SimDevice &device)
+{
+    if (deviceCount >= ADS1115_SIM_MAX_DEVICES || find(device.getAddress())) {
+        return false;
+    }
+    devices[deviceCount++] = &device;
+    device.update(now);
+    return true;
+}
+
+/** Take a device off the bus, e.g. to model it dropping out; transfers
+ * to its address are NACKed until it is attached again.
+ * @return False if it was not attached
+ */
+bool ADS1115SimBus::detach(ADS1115SimDevice &device)
+{
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i] == &device) {
+            devices[i] = devices[--deviceCount];
+            return true;
+        }
+    }
+    return false;
+}
+
+ADS1115SimDevice *ADS1115SimBus::find(uint8_t addr)
+{
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i]->getAddress() == addr) {
+            return devices[i];
+        }
+    }
+    return 0;
+}
+
+/** Set the SCL frequency used to time transactions.
+ * @param hz e.g. 100000, 400000 or 3400000
+ */
+void ADS1115SimBus::setClock(uint32_t hz)
+{
+    if (hz) {
+        clockHz = hz;
+    }
+}
+
+/** Virtual time in us, rounded up so a wait computed from it never ends
+ * early.
+ */
+uint32_t ADS1115SimBus::micros()
+{
+    return (uint32_t)((now + 999) / 1000);
+}
+
+void ADS1115SimBus::sleepMicros(uint32_t us)
+{
+    advance((uint64_t)us * 1000);
+}
+
+/** Move the clock forward, playing device events on the way.
+ * @param ns Time to let pass
+ */
+void ADS1115SimBus::advance(uint64_t ns)
+{
+    runTo(now + ns);
+}
+
+void ADS1115SimBus::runTo(uint64_t target)
+{
+    for (;;) {
+        ADS1115SimDevice *first = 0;
+        uint64_t next = target;
+        for (uint8_t i = 0; i < deviceCount; i++) {
+            uint64_t event = devices[i]->nextEvent();
+            if (event <= next) {
+                next = event;
+                first = devices[i];
+            }
+        }
+        if (!first) {
+            break;
+        }
+        if (next > now) {
+            now = next;
+        }
+        first->update(now);     // handlers may move now on
+    }
+    if (target > now) {
+        now = target;
+    }
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        devices[i]->update(now);
+    }
+}
+
+uint64_t ADS1115SimBus::bitsToNanos(uint32_t bits) const
+{
+    return ((uint64_t)bits * 1000000000ULL + clockHz - 1) / clockHz;
+}
+
+/** Zero the transaction, byte and busy-time counters.
+ */
+void ADS1115SimBus::resetCounters()
+{
+    transactions = 0;
+    bytes = 0;
+    busyNs = 0;
+}
+
+// A transaction is S, address + data bytes of 9 bits (8 + ACK), and P;
+// a combined one adds Sr and a second address byte.
+uint8_t ADS1115SimBus::write(uint8_t addr, const uint8_t *data, uint8_t len)
+{
+    ADS1115SimDevice *device = find(addr);
+    uint64_t duration = bitsToNanos(device ? 2 + 9 * (1 + len) : 2 + 9);
+
+    transactions++;
+    bytes += device ? 1 + len : 1;
+    busyNs += duration;
+    runTo(now + duration);
+    if (!device) {
+        return ADS1115_BUS_NACK_ADDR;
+    }
+    if (len == 0) {
+        return ADS1115_BUS_OK;
+    }
+    return device->write(data, len);
+}
+
+uint8_t ADS1115SimBus::read(uint8_t addr, uint8_t *data, uint8_t len)
+{
+    ADS1115SimDevice *device = find(addr);
+    bool acked = device || addr == ADS1115_SIM_ALERT_RESPONSE;
+    uint64_t duration = bitsToNanos(acked ? 2 + 9 * (1 + len) : 2 + 9);
+
+    transactions++;
+    bytes += acked ? 1 + len : 1;
+    busyNs += duration;
+    runTo(now + duration);
+    if (addr == ADS1115_SIM_ALERT_RESPONSE && len > 0) {
+        // lowest address wins the arbitration
+        for (uint8_t a = 0x48; a <= 0x4B; a++) {
+            ADS1115SimDevice *alerting = find(a);
+            if (alerting && alerting->alertResponse()) {
+                data[0] = a << 1;
+                return 1;
+            }
+        }
+        return 0;
+    }
+    if (!device) {
+        return 0;
+    }
+    return device->read(data, len);
+}
+
+uint8_t ADS1115SimBus::writeRead(uint8_t addr, const uint8_t *wdata,
+                                 uint8_t wlen, uint8_t *rdata, uint8_t rlen)
+{
+    ADS1115SimDevice *device = find(addr);
+    uint64_t first, second;
+
+    if (!device) {
+        return read(addr, rdata, 0);
+    }
+    first = bitsToNanos(1 + 9 * (1 + wlen));
+    second = bitsToNanos(1 + 9 * (1 + rlen) + 1);
+    transactions++;
+    bytes += 2 + wlen + rlen;
+    busyNs += first + second;
+
+    runTo(now + first);
+    if (wlen && device->write(wdata, wlen) != ADS1115_BUS_OK) {
+        return 0;
+    }
+    runTo(now + second);
+    return device->read(rdata, rlen);
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
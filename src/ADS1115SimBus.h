@@ -0,0 +1,146 @@
+#ifndef _ADS1115SIMBUS_H_
+#define _ADS1115SIMBUS_H_
+
+#include <inttypes.h>
+
+#define ADS1115_SIM_MAX_DEVICES     4
+#define ADS1115_SIM_ALERT_RESPONSE  0x0C    // SMBus alert response address
+#define ADS1115_SIM_RDY_PULSE_NS    8000    // continuous-mode RDY pulse width
+#define ADS1115_SIM_CLOCK_HZ        400000  // default SCL frequency
+
+/** Analog input source: voltage of one AIN pin at a point in time.
+ * @param context As passed to ADS1115SimDevice::setWaveform()
+ * @param timeNs Virtual time of the sample
+ * @return Pin voltage in microvolts, relative to GND
+ */
+typedef int32_t (*ADS1115SimWaveform)(void *context, uint64_t timeNs);
+
+/** Called on every level change of the ALERT/RDY pin.
+ * The device state is consistent when it runs, so the handler may talk to
+ * the bus, like an interrupt handler would.
+ * @param level New pin level, true = high
+ */
+typedef void (*ADS1115SimAlertHandler)(void *context, bool level);
+
+/** Timed ADS1115 model.
+ * Implements the pointer register, CONFIG, CONVERSION and both threshold
+ * registers. Conversions take 1/DR (plus ADS1115_WAKEUP_US out of power-down)
+ * on an oscillator with a settable error; in single-shot mode OS starts one
+ * and reads 0 until it completes, in continuous mode CONFIG writes restart
+ * the conversion cycle. Each result samples the analog pins at completion
+ * time, scaled by the PGA and clipped like the real part. The ALERT/RDY pin
+ * follows the comparator (traditional or window, queue, latch, polarity) or,
+ * with the threshold MSBs set for it, the conversion-ready signal.
+ *
+ * The device has no clock of its own: its owner moves it forward with
+ * update() before each access, as ADS1115SimBus does.
+ */
+class ADS1115SimDevice {
+    public:
+        ADS1115SimDevice(uint8_t address);
+
+        void reset();
+        void setInput(uint8_t mux, int16_t counts);
+        void setVoltage(uint8_t pin, int32_t microVolts);
+        void setWaveform(uint8_t pin, ADS1115SimWaveform waveform,
+                         void *context);
+        void setOscillatorError(int32_t ppm);
+        void setAlertHandler(ADS1115SimAlertHandler handler, void *context);
+
+        void update(uint64_t nowNs);
+        uint64_t nextEvent() const;
+
+        uint8_t getAddress() const { return devAddr; }
+        uint8_t getPointer() const { return pointer; }
+        uint16_t getRegister(uint8_t regAddr) const;
+        bool getAlertPin() const { return alertLevel; }
+        uint32_t getAlertEdges() const { return alertEdges; }
+        uint32_t getConversions() const { return conversions; }
+
+        uint8_t write(const uint8_t *data, uint8_t len);
+        uint8_t read(uint8_t *data, uint8_t len);
+        bool alertResponse();
+
+    private:
+        void start(uint64_t delayNs);
+        void complete(uint64_t at);
+        int16_t sample(uint64_t at) const;
+        int32_t pinVoltage(uint8_t pin, uint64_t at) const;
+        uint64_t period() const;
+        void compare(int16_t value);
+        void updatePin();
+
+        uint8_t  devAddr;
+        uint8_t  pointer;
+        uint16_t regs[4];
+        uint16_t convConfig;    // CONFIG the running conversion started with
+        bool     busy;
+        uint64_t clock;         // time of the last update()
+        uint64_t doneAt;
+        uint64_t pulseEndAt;    // 0 = no RDY pulse
+        bool     readyHeld;     // single-shot RDY, until the next start
+        bool     alertActive;
+        uint8_t  queueCount;
+        bool     alertLevel;
+        uint32_t alertEdges;
+        uint32_t conversions;
+        int32_t  oscPpm;
+        ADS1115SimAlertHandler alertHandler;
+        void    *alertContext;
+        uint8_t  fixedMask;     // MUX settings with a setInput() result
+        int16_t  fixed[8];
+        int32_t  pinUv[4];
+        ADS1115SimWaveform waveform[4];
+        void    *waveformContext[4];
+};
+
+/** Simulated I2C bus carrying up to four ADS1115SimDevice instances.
+ * Its clock is virtual. Every transaction moves it by the time the bits
+ * take at the configured SCL rate (start, address, data, ACKs, stop), and
+ * sleepMicros() moves it by the time asked for. Device events that fall in
+ * between (conversion ends, ALERT/RDY edges) are played in time order, so
+ * runs are deterministic and repeatable. The bus also counts transactions,
+ * bytes and the time the bus was busy.
+ */
+class ADS1115SimBus {
+    public:
+        ADS1115SimBus();
+
+        bool attach(ADS1115SimDevice &device);
+        bool detach(ADS1115SimDevice &device);
+        ADS1115SimDevice *find(uint8_t addr);
+
+        void setClock(uint32_t hz);
+        uint32_t getClock() const { return clockHz; }
+
+        void begin() {}
+        uint32_t micros();
+        uint64_t nanos() const { return now; }
+        void sleepMicros(uint32_t us);
+        void advance(uint64_t ns);
+        uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len);
+        uint8_t read(uint8_t addr, uint8_t *data, uint8_t len);
+        uint8_t writeRead(uint8_t addr, const uint8_t *wdata, uint8_t wlen,
+                          uint8_t *rdata, uint8_t rlen);
+
+        uint32_t getTransactions() const { return transactions; }
+        uint32_t getBytes() const { return bytes; }
+        uint64_t getBusyNanos() const { return busyNs; }
+        void resetCounters();
+
+    private:
+        void runTo(uint64_t target);
+        uint64_t bitsToNanos(uint32_t bits) const;
+
+        ADS1115SimDevice *devices[ADS1115_SIM_MAX_DEVICES];
+        uint8_t  deviceCount;
+        uint32_t clockHz;
+        uint64_t now;
+        uint32_t transactions;
+        uint32_t bytes;
+        uint64_t busyNs;
+};
+
+#endif /* _ADS1115SIMBUS_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
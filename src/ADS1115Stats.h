@@ -0,0 +1,113 @@
+#ifndef _ADS1115STATS_H_
+#define _ADS1115STATS_H_
+
+#include <inttypes.h>
+
+// Histogram buckets: bucket 0 holds 0..1 us, bucket b holds [2^b, 2^(b+1))
+// us, and the last one everything above. With 19 buckets the last bounded
+// one ends at 262 ms, past the slowest conversion (8 SPS: 125 ms, up to
+// about 138 ms on a slow oscillator), so only stalls land in the overflow.
+#ifndef ADS1115_STATS_BUCKETS
+#define ADS1115_STATS_BUCKETS       19
+#endif
+
+/** Fixed-bucket log2 latency histogram, in microseconds.
+ */
+struct ADS1115Histogram {
+    uint32_t count[ADS1115_STATS_BUCKETS];
+
+    void reset()
+    {
+        for (uint8_t b = 0; b < ADS1115_STATS_BUCKETS; b++) {
+            count[b] = 0;
+        }
+    }
+
+    void add(uint32_t us)
+    {
+        uint8_t b = 0;
+
+        while (us > 1 && b < ADS1115_STATS_BUCKETS - 1) {
+            us >>= 1;
+            b++;
+        }
+        count[b]++;
+    }
+
+    uint32_t total() const
+    {
+        uint32_t sum = 0;
+
+        for (uint8_t b = 0; b < ADS1115_STATS_BUCKETS; b++) {
+            sum += count[b];
+        }
+        return sum;
+    }
+
+    /** Exclusive upper bound of a bucket, in us (UINT32_MAX for the last).
+     */
+    static uint32_t bucketLimit(uint8_t bucket)
+    {
+        return bucket >= ADS1115_STATS_BUCKETS - 1 ? UINT32_MAX :
+               (uint32_t)2 << bucket;
+    }
+
+    /** Upper bound of the bucket holding the given percentile.
+     * @param pct 0..100
+     * @return Latency in us, 0 if the histogram is empty
+     */
+    uint32_t percentile(uint8_t pct) const
+    {
+        uint32_t want = (uint32_t)(((uint64_t)total() * pct + 99) / 100);
+        uint32_t seen = 0;
+
+        if (want == 0) {
+            want = 1;
+        }
+        for (uint8_t b = 0; b < ADS1115_STATS_BUCKETS; b++) {
+            seen += count[b];
+            if (seen >= want) {
+                return bucketLimit(b);
+            }
+        }
+        return 0;
+    }
+};
+
+/** Per-device hot-path counters, collected when ADS1115_STATS is defined.
+ * Poll and latency figures cover the driver's own single-shot waits
+ * (getConversion(), scan(), poll(), getAutoRanged() ...); the ready latency
+ * runs from the trigger to the OS bit being seen set, the conversion
+ * latency from the trigger to the result having been read.
+ * @see ADS1115::getStats()
+ */
+struct ADS1115Stats {
+    uint32_t registerReads;
+    uint32_t registerWrites;
+    uint32_t nacks;             // writes NAKed, reads with no reply
+    uint32_t busErrors;         // writes failing otherwise
+    uint32_t shortReads;        // reads cut short after the first byte
+    uint32_t conversions;       // waits that saw the OS bit set
+    uint32_t pollIterations;    // CONFIG polls inside those waits
+    uint32_t pollTimeouts;
+    ADS1115Histogram readyLatency;
+    ADS1115Histogram conversionLatency;
+
+    void reset()
+    {
+        registerReads = 0;
+        registerWrites = 0;
+        nacks = 0;
+        busErrors = 0;
+        shortReads = 0;
+        conversions = 0;
+        pollIterations = 0;
+        pollTimeouts = 0;
+        readyLatency.reset();
+        conversionLatency.reset();
+    }
+};
+
+#endif /* _ADS1115STATS_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,335 @@
+#include "ADS1115.h"
+#include "ADS1115Stream.h"
+
+// Polls more than this far apart (about 4.5 minutes) can no longer be
+// scheduled in 1/16 us; the stream restarts its schedule and counts the
+// conversions it slept through as missed.
+#define ADS1115_STREAM_MAX_GAP_US   0x0FFFFFFFUL
+
+// getMeasuredTrim() stops extending its window before the us clock wraps.
+#define ADS1115_STREAM_MAX_TRIM_US  0x7FFFFFFFUL
+
+/** Stream reader for one device.
+ * @param adc Device to stream from; MUX, PGA and rate are taken as set
+ */
+ADS1115Stream::ADS1115Stream(ADS1115 &adc)
+{
+    this->adc = &adc;
+    trimPpm = 0;
+    period16 = 0;
+    guard16 = 0;
+    anchorUs = 0;
+    anchorFrac16 = 0;
+    nextSequence = 0;
+    missed = 0;
+    late = 0;
+    overflows = 0;
+    rate = 0;
+    status = ADS1115_STATUS_OK;
+    running = false;
+    readySync = false;
+    overdue = false;
+    trimStarted = false;
+    readyEdges = 0;
+    readyTaken = 0;
+    readyOverflow = false;
+    readyUs = 0;
+    firstSyncUs = lastSyncUs = 0;
+    firstSyncSequence = lastSyncSequence = 0;
+}
+
+/** Correct the schedule for a measured oscillator error.
+ * Takes effect on the next begin().
+ * @param ppm Oscillator error; positive when the device runs fast
+ */
+void ADS1115Stream::setOscillatorTrim(int32_t ppm)
+{
+    trimPpm = ppm;
+}
+
+/** Switch the device to continuous mode and start the schedule.
+ * CONFIG is read back from the device rather than taken from the shadow,
+ * so a device that is not there fails here instead of streaming zeros.
+ * The CONFIG write restarts conversions, so conversion 0 completes one
+ * period (plus wake-up) after this returns.
+ * @param readySync True to put ALERT/RDY in conversion-ready mode and take
+ *        timing and sequence from onReady() instead of the schedule
+ * @return False if a register access failed; the stream then stays stopped
+ *         and getLastStatus() says why
+ * @see ADS1115::setConversionReadyPinMode()
+ */
+bool ADS1115Stream::begin(bool readySync)
+{
+    uint16_t config;
+
+    running = false;
+    adc->invalidate();
+    if (readySync) {
+        adc->setHighThreshold(-1);
+        if (adc->getBusStatus() == ADS1115_STATUS_OK) {
+            adc->setLowThreshold(0);
+        }
+        if (adc->getBusStatus() != ADS1115_STATUS_OK) {
+            status = adc->getBusStatus();
+            return false;
+        }
+    }
+    config = adc->getConfig() & ~ADS1115_CFG_MODE_BIT;
+    if (adc->getBusStatus() != ADS1115_STATUS_OK) {
+        status = adc->getBusStatus();
+        return false;
+    }
+    if (readySync) {
+        // the rest of setConversionReadyPinMode(), in the same write
+        config &= ~(ADS1115_CFG_COMP_POL_BIT | ADS1115_CFG_COMP_QUE_MASK);
+    }
+    rate = ADS1115CFG::dataRate((config & ADS1115_CFG_DR_MASK) >>
+                                ADS1115_CFG_DR_SHIFT);
+    period16 = (uint32_t)(16000000000000ULL /
+                          ((uint64_t)rate * (uint64_t)(1000000 + trimPpm)));
+    guard16 = period16 / 8;
+
+    adc->setConfig(config);
+    if (adc->getBusStatus() != ADS1115_STATUS_OK) {
+        status = adc->getBusStatus();
+        return false;
+    }
+    anchorUs = adc->getBus().micros() + ADS1115_WAKEUP_US;
+    anchorFrac16 = 0;
+    adc->getConversion(false);  // park the pointer on CONVERSION
+    status = adc->getLastStatus();
+    if (status != ADS1115_STATUS_OK) {
+        return false;
+    }
+
+    nextSequence = 0;
+    missed = 0;
+    late = 0;
+    overflows = 0;
+    overdue = false;
+    trimStarted = false;
+    readyOverflow = false;
+    __atomic_store_n(&readyTaken,
+                     __atomic_load_n(&readyEdges, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+    firstSyncUs = lastSyncUs = 0;
+    firstSyncSequence = lastSyncSequence = 0;
+    this->readySync = readySync;
+    running = true;
+    return true;
+}
+
+/** Note one conversion-ready edge, after begin(true).
+ * Only stores the time; the read happens in poll(). Call it from the
+ * ALERT/RDY pin interrupt or a GPIO edge thread.
+ */
+void ADS1115Stream::onReady()
+{
+    ADS1115RingIndex taken = __atomic_load_n(&readyTaken, __ATOMIC_ACQUIRE);
+
+    readyUs = adc->getBus().micros();
+    // Saturate rather than wrap back to "no new edges"
+    if ((ADS1115RingIndex)(readyEdges - taken) == (ADS1115RingIndex)~0) {
+        readyOverflow = true;
+        return;
+    }
+    __atomic_store_n(&readyEdges, (ADS1115RingIndex)(readyEdges + 1),
+                     __ATOMIC_RELEASE);
+}
+
+/** Oscillator error measured from the RDY edges of this run, to pass to
+ * setOscillatorTrim() for later runs without the pin. Uses up to about 35
+ * minutes of edges.
+ * @return Error in ppm, positive when the device runs fast; 0 until two
+ *         synced samples have been read
+ */
+int32_t ADS1115Stream::getMeasuredTrim() const
+{
+    uint32_t conversions = lastSyncSequence - firstSyncSequence;
+    uint64_t nominal = (uint64_t)rate * (lastSyncUs - firstSyncUs);
+
+    if (conversions == 0 || nominal == 0) {
+        return 0;
+    }
+    // (actual rate / nominal rate - 1) * 1e6
+    return (int32_t)(((int64_t)conversions * 1000000 - (int64_t)nominal) *
+                     1000000 / (int64_t)nominal);
+}
+
+/** Stop streaming and return the device to single-shot mode.
+ */
+void ADS1115Stream::end()
+{
+    running = false;
+    adc->setMode(ADS1115_MODE_SINGLESHOT);
+}
+
+void ADS1115Stream::advance(uint32_t conversions)
+{
+    uint64_t total = (uint64_t)conversions * period16 + anchorFrac16;
+
+    anchorUs += (uint32_t)(total >> 4);
+    anchorFrac16 = total & 0x0F;
+}
+
+/** Take the newest conversion if one has completed since the last read.
+ * Never blocks and never reads the bus before a new conversion is due.
+ * @param sample Filled in when a sample is returned
+ * @return True if a sample was read; false if none was due or the read
+ *         failed, in which case getLastStatus() has the bus status
+ */
+bool ADS1115Stream::poll(ADS1115StreamSample &sample)
+{
+    uint32_t now, elapsed, elapsed16, conversions;
+
+    if (!running) {
+        return false;
+    }
+    if (readySync) {
+        return pollReady(sample);
+    }
+    now = adc->getBus().micros();
+    elapsed = now - anchorUs;
+    if ((int32_t)elapsed < 0) {
+        return false;
+    }
+    if (elapsed >= ADS1115_STREAM_MAX_GAP_US) {
+        conversions = (uint32_t)(((uint64_t)elapsed << 4) / period16);
+        missed += conversions;
+        nextSequence += conversions;
+        advance(conversions);
+        return false;
+    }
+
+    elapsed16 = (elapsed << 4) - anchorFrac16;
+    if (elapsed16 < period16 + guard16) {
+        return false;
+    }
+    conversions = (elapsed16 - guard16) / period16;
+
+    sample.value = adc->getConversion(false);
+    status = adc->getLastStatus();
+    if (status != ADS1115_STATUS_OK) {
+        return false;
+    }
+    sample.sequence = nextSequence + conversions - 1;
+    sample.flags = 0;
+    missed += conversions - 1;
+    advance(conversions);
+    sample.timestamp = anchorUs;
+
+    nextSequence = sample.sequence + 1;
+    return true;
+}
+
+/** poll() with RDY re-sync: read once per batch of new edges and move the
+ * schedule onto the latest one.
+ */
+bool ADS1115Stream::pollReady(ADS1115StreamSample &sample)
+{
+    ADS1115RingIndex edges, check;
+    uint32_t at, count;
+
+    if (__atomic_load_n(&readyEdges, __ATOMIC_ACQUIRE) == readyTaken) {
+        // Due by the schedule but not landed: a plain scheduled read would
+        // have returned the previous conversion again
+        if (!overdue &&
+            ((adc->getBus().micros() - anchorUs) << 4) - anchorFrac16 >=
+            period16 + guard16) {
+            overdue = true;
+            late++;
+        }
+        return false;
+    }
+    sample.value = adc->getConversion(false);
+    status = adc->getLastStatus();
+    if (status != ADS1115_STATUS_OK) {
+        return false;   // the edges stay pending for the retry
+    }
+
+    // Count the edges after the read, so an edge landing during it is
+    // taken as this sample rather than read again next time
+    do {
+        edges = __atomic_load_n(&readyEdges, __ATOMIC_ACQUIRE);
+        at = readyUs;
+        check = __atomic_load_n(&readyEdges, __ATOMIC_ACQUIRE);
+    } while (edges != check);
+    count = (ADS1115RingIndex)(edges - readyTaken);
+    __atomic_store_n(&readyTaken, edges, __ATOMIC_RELEASE);
+    if (readyOverflow) {
+        // The counter saturated: take the gap from the edge times
+        readyOverflow = false;
+        overflows++;
+        uint32_t periods = (uint32_t)(((uint64_t)(at - anchorUs) * rate *
+                                       (uint64_t)(1000000 + trimPpm) +
+                                       500000000000ULL) / 1000000000000ULL);
+        if (periods > count) {
+            count = periods;
+        }
+    }
+
+    sample.sequence = nextSequence + count - 1;
+    sample.timestamp = at;
+    sample.flags = ADS1115_STREAM_SYNCED;
+    missed += count - 1;
+    nextSequence = sample.sequence + 1;
+    anchorUs = at;
+    anchorFrac16 = 0;
+    overdue = false;
+
+    if (!trimStarted) {
+        trimStarted = true;
+        firstSyncUs = at;
+        firstSyncSequence = sample.sequence;
+    }
+    if (at - firstSyncUs <= ADS1115_STREAM_MAX_TRIM_US) {
+        lastSyncUs = at;
+        lastSyncSequence = sample.sequence;
+    }
+    return true;
+}
+
+/** Fill a caller-supplied block with consecutive samples.
+ * Sleeps on the bus clock until each conversion is due, so the CPU is free
+ * between samples (and other tasks run on cores whose delay() yields).
+ * @param samples Destination
+ * @param count Number of samples wanted
+ * @return Number of samples delivered: count, or fewer if the stream is
+ *         stopped, a read fails (getLastStatus() has the bus status) or,
+ *         with RDY sync, no edge came for ADS1115_STREAM_READY_TIMEOUT
+ *         periods (ADS1115_STATUS_TIMEOUT)
+ */
+uint16_t ADS1115Stream::read(ADS1115StreamSample *samples, uint16_t count)
+{
+    uint16_t got = 0;
+
+    status = ADS1115_STATUS_OK;
+    while (running && got < count) {
+        if (poll(samples[got])) {
+            got++;
+            continue;
+        }
+        if (status != ADS1115_STATUS_OK) {
+            break;
+        }
+
+        uint32_t elapsed = adc->getBus().micros() - anchorUs;
+        uint32_t due16 = period16 + guard16 + anchorFrac16;
+        uint32_t wait = 1;
+        if ((int32_t)elapsed < 0) {
+            wait = (uint32_t)(-(int32_t)elapsed) + (due16 >> 4) + 1;
+        } else if ((elapsed << 4) < due16) {
+            wait = ((due16 - (elapsed << 4)) >> 4) + 1;
+        } else if (readySync &&
+                   ((uint64_t)elapsed << 4) >= (uint64_t)period16 *
+                   ADS1115_STREAM_READY_TIMEOUT + anchorFrac16) {
+            // RDY not wired or the device is gone: nothing will come
+            status = ADS1115_STATUS_TIMEOUT;
+            break;
+        }
+        adc->getBus().sleepMicros(wait);
+    }
+    return got;
+}
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
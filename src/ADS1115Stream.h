@@ -0,0 +1,108 @@
+#ifndef _ADS1115STREAM_H_
+#define _ADS1115STREAM_H_
+
+#include <inttypes.h>
+
+#include "ADS1115Ring.h"
+
+class ADS1115;
+
+#define ADS1115_STREAM_SYNCED       0x01 // timed by a RDY edge
+
+// Conversion periods without a RDY edge after which read() gives up
+#ifndef ADS1115_STREAM_READY_TIMEOUT
+#define ADS1115_STREAM_READY_TIMEOUT 4
+#endif
+
+/** One continuous-mode sample.
+ * timestamp is the completion time of the conversion on the bus clock (us,
+ * wraps like micros()): scheduled, or the RDY edge time if
+ * ADS1115_STREAM_SYNCED is set. sequence counts conversions since
+ * ADS1115Stream::begin(), so a gap means conversions were missed.
+ */
+struct ADS1115StreamSample {
+    uint32_t timestamp;
+    uint32_t sequence;
+    int16_t  value;
+    uint8_t  flags;
+};
+
+/** Continuous-mode reader that schedules reads from the configured DR.
+ * The stream tracks when each conversion completes from the data rate (plus
+ * an optional oscillator trim) and reads the CONVERSION register exactly
+ * once per new conversion, just after it lands. Reads that fall behind
+ * skip ahead and count the skipped conversions as missed. Nothing
+ * allocates.
+ *
+ * Without a sync signal the schedule can only be as good as the
+ * oscillator (+/-10% worst case): a slow device is read twice and a fast
+ * one loses conversions, and the stream cannot tell, so getMissed() only
+ * counts reads that fell behind the schedule and getLate() stays 0.
+ * Measure the real rate once and pass it to setOscillatorTrim() for long
+ * gap-free runs, or re-sync on RDY: after begin(true), call onReady() on
+ * every ALERT/RDY edge. It only notes the time, so it is safe in any
+ * interrupt handler, and the stream then reads once per edge. Missed
+ * conversions are counted from the edges, and getLate() counts the
+ * conversions that came due by the schedule before their edge, each one a
+ * read the plain schedule would have repeated. If more edges arrive
+ * between two polls than the edge counter holds, it stops counting and the
+ * next poll works the gap out from the edge time instead; getOverflows()
+ * says how often that happened.
+ *
+ * A read the device does not answer delivers nothing: poll() returns
+ * false with the schedule and sequence left where they were, so the next
+ * poll retries the same conversion, and getLastStatus() says why. read()
+ * returns the samples it has at the first such failure, and with RDY sync
+ * also once ADS1115_STREAM_READY_TIMEOUT periods pass without an edge.
+ */
+class ADS1115Stream {
+    public:
+        ADS1115Stream(ADS1115 &adc);
+
+        bool begin(bool readySync = false);
+        void end();
+        void setOscillatorTrim(int32_t ppm);
+        void onReady();
+
+        bool poll(ADS1115StreamSample &sample);
+        uint16_t read(ADS1115StreamSample *samples, uint16_t count);
+
+        uint32_t getMissed() const { return missed; }
+        uint32_t getLate() const { return late; }
+        uint32_t getOverflows() const { return overflows; }
+        uint8_t getLastStatus() const { return status; }
+        int32_t getMeasuredTrim() const;
+
+    private:
+        void advance(uint32_t conversions);
+        bool pollReady(ADS1115StreamSample &sample);
+
+        ADS1115 *adc;
+        int32_t  trimPpm;
+        uint32_t period16;      // conversion period, 1/16 us
+        uint32_t guard16;       // read this long after the nominal boundary
+        uint32_t anchorUs;      // completion time of the last conversion read
+        uint8_t  anchorFrac16;
+        uint32_t nextSequence;
+        uint32_t missed;
+        uint32_t late;
+        uint32_t overflows;
+        uint16_t rate;          // nominal samples per second
+        uint8_t  status;        // of the last read, or read()'s timeout
+        bool     running;
+        bool     readySync;
+        bool     overdue;       // schedule passed with no RDY edge yet
+        bool     trimStarted;
+        ADS1115RingIndex readyEdges;    // written by onReady() only
+        ADS1115RingIndex readyTaken;
+        volatile bool readyOverflow;    // onReady() dropped edges
+        volatile uint32_t readyUs;      // time of the latest edge
+        uint32_t firstSyncUs;   // first and latest synced sample, for
+        uint32_t firstSyncSequence;     // getMeasuredTrim()
+        uint32_t lastSyncUs;
+        uint32_t lastSyncSequence;
+};
+
+#endif /* _ADS1115STREAM_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4
@@ -0,0 +1,74 @@
+#ifndef _ADS1115WIREBUS_H_
+#define _ADS1115WIREBUS_H_
+
+#include <inttypes.h>
+#include <Wire.h>
+
+// Longest a single transfer may hang (SDA held low, no clock) before Wire
+// gives up and resets the TWI hardware. Only on cores whose Wire supports
+// it (WIRE_HAS_TIMEOUT); 0 keeps the core's default.
+#ifndef ADS1115_WIRE_TIMEOUT_US
+#define ADS1115_WIRE_TIMEOUT_US     25000
+#endif
+
+/** Arduino TwoWire transport.
+ * Stateless; every method is a thin inline wrapper around the global Wire
+ * object so the driver compiles to the same calls it always made.
+ */
+class ADS1115WireBus {
+    public:
+        void begin()
+        {
+            Wire.begin();
+#if defined(WIRE_HAS_TIMEOUT)
+            if (ADS1115_WIRE_TIMEOUT_US) {
+                Wire.setWireTimeout(ADS1115_WIRE_TIMEOUT_US, true);
+            }
+#endif
+        }
+
+        uint8_t write(uint8_t addr, const uint8_t *data, uint8_t len)
+        {
+            Wire.beginTransmission(addr);
+            Wire.write(data, len);
+            return Wire.endTransmission();
+        }
+
+        uint8_t read(uint8_t addr, uint8_t *data, uint8_t len)
+        {
+            uint8_t count = Wire.requestFrom(addr, len);
+            for (uint8_t i = 0; i < count; i++) {
+                data[i] = Wire.read();
+            }
+            return count;
+        }
+
+        uint8_t writeRead(uint8_t addr, const uint8_t *wdata, uint8_t wlen,
+                          uint8_t *rdata, uint8_t rlen)
+        {
+            Wire.beginTransmission(addr);
+            Wire.write(wdata, wlen);
+            if (Wire.endTransmission(false) != 0) {
+                return 0;
+            }
+            return read(addr, rdata, rlen);
+        }
+
+        uint32_t micros()
+        {
+            return ::micros();
+        }
+
+        void sleepMicros(uint32_t us)
+        {
+            if (us >= 1000) {
+                delay(us / 1000);   // yields on cores that schedule
+                us %= 1000;
+            }
+            delayMicroseconds(us);
+        }
+};
+
+#endif /* _ADS1115WIREBUS_H_ */
+
+// vim:ts=4:sw=4:ai:et:si:sts=4